@@ -0,0 +1,27 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_COARSECLOCK_H
+#define INFLUXDATA_COARSECLOCK_H
+
+#include <chrono>
+
+namespace influxdb
+{
+
+/// \brief Cached wall clock updated by a background thread
+/// Reading it is a single atomic load instead of a clock_gettime call; precision equals the tick resolution
+class CoarseClock
+{
+  public:
+    /// \return last cached time, starts the tick thread on first call
+    static std::chrono::time_point<std::chrono::system_clock> now();
+
+    /// Sets tick period (default 10 ms)
+    static void setResolution(std::chrono::milliseconds resolution);
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_COARSECLOCK_H
@@ -0,0 +1,340 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_COROUTINE_H
+#define INFLUXDATA_COROUTINE_H
+
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "Coroutine.h requires C++20 coroutines"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "InfluxDB.h"
+
+/// Awaitable writes and queries (header only, C++20)
+/// Nothing blocks while awaiting: the request is transferred by the transport (concurrently with others over HTTP)
+/// and the coroutine is resumed from the transport thread once it completes. Move heavy work resumed this way
+/// to your own executor, as the transport thread serves all requests of the transport.
+/// Transports without asynchronous support complete the request before the coroutine suspends.
+namespace influxdb::coro
+{
+
+/// Resumes the coroutine once both the request is started and the completion handler ran (in any order)
+class Completion
+{
+  public:
+    bool await_ready() const noexcept { return false; }
+
+  protected:
+    /// \return whether to stay suspended, false if request already completed
+    bool suspend(std::coroutine_handle<> handle)
+    {
+      mHandle = handle;
+      return !mArrived.exchange(true, std::memory_order_acq_rel);
+    }
+
+    /// Called by completion handler
+    void complete()
+    {
+      if (mArrived.exchange(true, std::memory_order_acq_rel)) {
+        mHandle.resume();
+      }
+    }
+
+    /// Suspended coroutine
+    std::coroutine_handle<> mHandle;
+
+    /// Whether the other party (start or completion) arrived
+    std::atomic<bool> mArrived{false};
+
+    /// Request error
+    std::exception_ptr mError;
+};
+
+/// Awaitable query, returns points of all statements
+class Query : public Completion
+{
+  public:
+    Query(InfluxDB& influxdb, std::string query) : mInfluxDB(influxdb), mQuery(std::move(query)) {}
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+      mInfluxDB.queryAsync(mQuery, [this](std::vector<Point>&& points, std::exception_ptr error) {
+        mPoints = std::move(points);
+        mError = error;
+        complete();
+      });
+      return suspend(handle);
+    }
+
+    std::vector<Point> await_resume()
+    {
+      if (mError) {
+        std::rethrow_exception(mError);
+      }
+      return std::move(mPoints);
+    }
+
+  private:
+    InfluxDB& mInfluxDB;
+    std::string mQuery;
+    std::vector<Point> mPoints;
+};
+
+/// Awaitable write of points in a single transmission
+class Write : public Completion
+{
+  public:
+    Write(InfluxDB& influxdb, std::vector<Point>&& points) : mInfluxDB(influxdb), mPoints(std::move(points)) {}
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+      mInfluxDB.writeAsync(std::move(mPoints), [this](std::exception_ptr error) {
+        mError = error;
+        complete();
+      });
+      return suspend(handle);
+    }
+
+    void await_resume()
+    {
+      if (mError) {
+        std::rethrow_exception(mError);
+      }
+    }
+
+  private:
+    InfluxDB& mInfluxDB;
+    std::vector<Point> mPoints;
+};
+
+/// co_await query(influxdb, "SELECT ...") returns points, rethrows query errors
+inline Query query(InfluxDB& influxdb, std::string query)
+{
+  return Query(influxdb, std::move(query));
+}
+
+/// co_await write(influxdb, points) completes once the server accepted the points, rethrows transmission errors
+inline Write write(InfluxDB& influxdb, std::vector<Point> points)
+{
+  return Write(influxdb, std::move(points));
+}
+
+/// co_await write(influxdb, point)
+inline Write write(InfluxDB& influxdb, Point&& point)
+{
+  std::vector<Point> points;
+  points.push_back(std::move(point));
+  return Write(influxdb, std::move(points));
+}
+
+/// \brief Asynchronous generator: the producing coroutine may co_await, the consumer awaits next()
+/// while (auto value = co_await generator.next()) { ... }
+template<typename T>
+class Generator
+{
+  public:
+    struct promise_type
+    {
+      /// Yielded value
+      std::optional<T> value;
+
+      /// Exception thrown by the producer
+      std::exception_ptr error;
+
+      /// Coroutine awaiting next()
+      std::coroutine_handle<> consumer;
+
+      /// Transfers control back to the consumer
+      struct Yield
+      {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+        {
+          return handle.promise().consumer;
+        }
+        void await_resume() const noexcept {}
+      };
+
+      Generator get_return_object()
+      {
+        return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+      }
+      std::suspend_always initial_suspend() const noexcept { return {}; }
+      Yield final_suspend() const noexcept { return {}; }
+      Yield yield_value(T yielded)
+      {
+        value = std::move(yielded);
+        return {};
+      }
+      void return_void() const noexcept {}
+      void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    /// Awaitable of the next value, empty when the producer finished
+    class Next
+    {
+      public:
+        Next(std::coroutine_handle<promise_type> producer) : mProducer(producer) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept
+        {
+          mProducer.promise().consumer = consumer;
+          mProducer.promise().value.reset();
+          return mProducer;
+        }
+
+        std::optional<T> await_resume()
+        {
+          auto& promise = mProducer.promise();
+          if (promise.error) {
+            std::rethrow_exception(std::exchange(promise.error, nullptr));
+          }
+          return std::move(promise.value);
+        }
+
+      private:
+        std::coroutine_handle<promise_type> mProducer;
+    };
+
+    Generator(Generator&& other) noexcept : mHandle(std::exchange(other.mHandle, nullptr)) {}
+
+    Generator& operator=(Generator&& other) noexcept
+    {
+      std::swap(mHandle, other.mHandle);
+      return *this;
+    }
+
+    /// Destroys the producer, must not be awaiting next()
+    ~Generator()
+    {
+      if (mHandle) {
+        mHandle.destroy();
+      }
+    }
+
+    /// \return awaitable of the next value (must not be called after an empty one)
+    Next next()
+    {
+      return Next(mHandle);
+    }
+
+  private:
+    explicit Generator(std::coroutine_handle<promise_type> handle) : mHandle(handle) {}
+
+    std::coroutine_handle<promise_type> mHandle;
+};
+
+/// Chunks of a streamed query (InfluxDB::queryChunked) waiting for the consumer
+class Chunks : public std::enable_shared_from_this<Chunks>
+{
+  public:
+    /// Points of a chunk
+    struct Chunk
+    {
+      std::vector<Point> points;
+      bool last;
+    };
+
+    /// Starts the query
+    void start(InfluxDB& influxdb, const std::string& query, std::size_t chunkSize)
+    {
+      influxdb.queryChunked(query, [self = shared_from_this()](std::vector<Point>&& points, bool last,
+        std::exception_ptr error) {
+        std::coroutine_handle<> waiting;
+        {
+          std::lock_guard<std::mutex> lock(self->mMutex);
+          self->mChunks.push_back({std::move(points), last});
+          self->mError = error;
+          waiting = std::exchange(self->mWaiting, nullptr);
+        }
+        if (waiting) {
+          waiting.resume();
+        }
+      }, chunkSize);
+    }
+
+    /// Awaitable of the next chunk, resumed from the transport thread when none was received yet
+    class Next
+    {
+      public:
+        Next(Chunks& chunks) : mChunks(chunks) {}
+
+        bool await_ready() const
+        {
+          std::lock_guard<std::mutex> lock(mChunks.mMutex);
+          return !mChunks.mChunks.empty();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+          std::lock_guard<std::mutex> lock(mChunks.mMutex);
+          if (!mChunks.mChunks.empty()) {
+            return false;
+          }
+          mChunks.mWaiting = handle;
+          return true;
+        }
+
+        Chunk await_resume()
+        {
+          std::lock_guard<std::mutex> lock(mChunks.mMutex);
+          auto chunk = std::move(mChunks.mChunks.front());
+          mChunks.mChunks.pop_front();
+          if (chunk.last && mChunks.mError) {
+            std::rethrow_exception(mChunks.mError);
+          }
+          return chunk;
+        }
+
+      private:
+        Chunks& mChunks;
+    };
+
+    /// \return awaitable of the next chunk, rethrows query error
+    Next next()
+    {
+      return Next(*this);
+    }
+
+  private:
+    std::mutex mMutex;
+    std::deque<Chunk> mChunks;
+    std::exception_ptr mError;
+    std::coroutine_handle<> mWaiting;
+};
+
+/// Yields points of a query one by one as the response is streamed
+/// Over HTTP results arrive in chunks of at most chunkSize rows, each decoded once received, so the first points
+/// are yielded before the rest is transferred. Chunks are received ahead of the consumer, not throttled by it.
+inline Generator<Point> rows(InfluxDB& influxdb, std::string statement, std::size_t chunkSize = 10000)
+{
+  auto chunks = std::make_shared<Chunks>();
+  chunks->start(influxdb, statement, chunkSize);
+  for (;;) {
+    auto chunk = co_await chunks->next();
+    for (auto& point : chunk.points) {
+      co_yield std::move(point);
+    }
+    if (chunk.last) {
+      co_return;
+    }
+  }
+}
+
+} // namespace influxdb::coro
+
+#endif // INFLUXDATA_COROUTINE_H
@@ -5,11 +5,17 @@
 #ifndef INFLUXDATA_INFLUXDB_H
 #define INFLUXDATA_INFLUXDB_H
 
+#include <array>
 #include <chrono>
+#include <condition_variable>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <deque>
+#include <functional>
+#include <thread>
 
 #include "Transport.h"
 #include "Point.h"
@@ -17,9 +23,71 @@
 namespace influxdb
 {
 
+class QueryCache;
+class TagKeys;
+class CardinalityGuard;
+class BatchTuner;
+
+/// Behaviour of writes when pending data exceed memory budget
+enum class Backpressure {
+  Block,  ///< wait until transmissions free memory, throw on timeout
+  Drop,   ///< drop points that do not fit
+  Sample  ///< above half of the budget keep progressively fewer points, drop points that do not fit
+};
+
+/// Handling of points carrying the offending tag of a measurement over its series limit
+enum class CardinalityPolicy {
+  Drop,    ///< drop the points
+  Sample,  ///< keep 1 of 16 points
+  Rewrite  ///< replace value of the offending tag with "_overflow"
+};
+
+/// Priority class of written points
+enum class Priority {
+  High,    ///< eg. alerting metrics, shed last
+  Normal,
+  Low      ///< eg. debug metrics, shed first
+};
+
+/// Settings of a priority lane
+struct Lane
+{
+  std::size_t batchSize;               ///< points per transmission
+  std::chrono::milliseconds maxDelay;  ///< transmit partial batch once its oldest point waited this long
+  unsigned weight;                     ///< share of transmissions while lanes compete
+  unsigned retries;                    ///< retransmissions of a failed batch before it is dropped
+};
+
+/// Result of a statement of a batched query
+struct StatementResult
+{
+  std::vector<Point> points;
+  std::string error;  ///< error reported by the server for this statement, empty on success
+};
+
 class InfluxDB
 {
   public:
+    /// Writer statistics
+    struct Stats
+    {
+      std::size_t pendingBytes;                 ///< line protocol bytes buffered or being transmitted
+      std::size_t written;                      ///< points accepted
+      std::size_t dropped;                      ///< points rejected as memory budget was exhausted
+      std::size_t sampledOut;                   ///< points discarded by sampling
+      std::size_t compacted;                    ///< points merged into others by batch compaction
+      std::size_t compactedBytes;               ///< line protocol bytes saved by batch compaction
+      std::size_t shed;                         ///< buffered points dropped to admit points of higher priority
+      std::size_t failed;                       ///< points of batches dropped after failed background transmissions
+      std::size_t limited;                      ///< points dropped, sampled out or rewritten by cardinality limit
+      std::size_t transportDropped;             ///< messages discarded by the transport (eg. full queue of a replica)
+      std::size_t transportFailed;              ///< messages the transport failed to deliver in background (eg. replica down)
+      std::size_t batchSize;                    ///< current batch size (chosen by adaptive batching)
+      std::chrono::milliseconds flushInterval;  ///< maximum wait of a buffered point (adaptive batching)
+      std::chrono::microseconds sendLatency;    ///< average transmission time of recent batches (adaptive batching)
+      double throughput;                        ///< points per second of transmission time (adaptive batching)
+    };
+
     /// Disable copy constructor
     InfluxDB & operator=(const InfluxDB&) = delete;
 
@@ -32,28 +100,136 @@ class InfluxDB
     /// Flushes buffer
     ~InfluxDB();
 
-    /// Writes a metric
+    /// Writes a metric (thread-safe)
     /// \param metric
-    void write(Point&& metric);
+    /// \param priority  lane of the metric (see priorityLanes), under memory budget lower priorities are shed first
+    /// \throw InfluxDBException	if memory budget stays exhausted for the whole timeout (Backpressure::Block)
+    void write(Point&& metric, Priority priority = Priority::Normal);
+
+    /// Writes a metric unless memory budget is exhausted, never waits for memory to be released
+    /// A buffer holding the budget is not transmitted on the caller's thread (adaptive batching flushes it early)
+    /// \return false if metric was dropped
+    bool tryWrite(Point&& metric, Priority priority = Priority::Normal);
+
+    /// Queues points of each priority separately, a background sender transmits them (replaces batchOf)
+    /// While lanes compete, transmissions are shared by weight, so a flood of low priority points delays
+    /// high priority ones by at most a few batches. Transmission errors are retried and counted, not thrown.
+    /// Call before writing; points already buffered by batchOf() are queued with normal priority.
+    void priorityLanes(Lane high = {64, std::chrono::milliseconds(10), 8, 3},
+      Lane normal = {512, std::chrono::milliseconds(100), 4, 1},
+      Lane low = {4096, std::chrono::seconds(1), 1, 0});
+
+    /// Limits line protocol bytes buffered and being transmitted by all writers
+    /// \param bytes     budget, 0 disables the limit
+    /// \param policy    behaviour of write() when budget is exhausted
+    /// \param timeout   maximum blocking time of Backpressure::Block
+    void memoryBudget(std::size_t bytes, Backpressure policy = Backpressure::Block,
+      std::chrono::milliseconds timeout = std::chrono::seconds(1));
+
+    /// \return writer statistics
+    Stats stats() const;
+
+    /// Limits distinct series written per measurement, guarding the server against tag value explosions
+    /// Series and tag values are counted with HyperLogLog (~3% error, 1 KiB per measurement and tag key).
+    /// Once a measurement exceeds the limit, its tag key with most distinct values is deemed offending
+    /// and written points carrying it are handled by policy (counted in Stats::limited). Call before writing.
+    void cardinalityLimit(std::size_t series, CardinalityPolicy policy = CardinalityPolicy::Rewrite);
+
+    /// \return estimated distinct series written to measurement (0 without cardinality limit)
+    std::size_t seriesCardinality(std::string_view measurement) const;
 
     /// Queries InfluxDB database
     std::vector<Point> query(const std::string& query);
 
+    /// Queries InfluxDB database without waiting for the response (HTTP runs queries concurrently)
+    /// \return future of points, get() rethrows query errors
+    std::future<std::vector<Point>> queryAsync(const std::string& query);
+
+    /// Queries InfluxDB database without waiting for the response, for event loops and coroutines (see Coroutine.h)
+    /// \param handler   receives points or query error, may be called from the transport thread
+    void queryAsync(const std::string& query, std::function<void(std::vector<Point>&&, std::exception_ptr)> handler);
+
+    /// Streams query results: over HTTP the server returns them in chunks of at most chunkSize rows (chunked=true),
+    /// each decoded and handed over as soon as it is received; other transports return all points at once
+    /// \param handler   receives points of each chunk in order, last call is flagged; an error ends the stream,
+    ///                  called from the transport thread
+    void queryChunked(const std::string& query,
+      std::function<void(std::vector<Point>&&, bool last, std::exception_ptr)> handler, std::size_t chunkSize = 10000);
+
+    /// Writes points in a single transmission without waiting for it (HTTP transfers writes concurrently);
+    /// bypasses batching. Points are admitted as by tryWrite() (cardinality limit, memory budget, statistics),
+    /// rejected ones are not sent; with priority lanes points are queued with normal priority instead.
+    /// \param handler   receives transmission error (null on success, or when nothing was left to transmit),
+    ///                  may be called from the transport thread
+    void writeAsync(std::vector<Point>&& points, std::function<void(std::exception_ptr)> handler);
+
+    /// Sends several statements in a single request, a failed statement does not discard results of others
+    /// \return points and error of each statement, in order of statements
+    /// \throw InfluxDBException if the whole request failed
+    std::vector<StatementResult> queryBatch(const std::vector<std::string>& statements);
+
+    /// Sends several statements in a single request without waiting for the response
+    /// \return future of points and error of each statement, in order of statements
+    std::future<std::vector<StatementResult>> queryBatchAsync(const std::vector<std::string>& statements);
+
+    /// Enables caching of query() results (SELECT and SHOW only)
+    /// \param ttl          how long results are reused
+    /// \param incremental  refresh expired GROUP BY time() results from the last cached bucket on,
+    ///                     keeping older (complete) buckets
+    void cacheQueries(std::chrono::milliseconds ttl, bool incremental = false);
+
     /// Flushes metric buffer (this can also happens when buffer is full)
+    /// With priority lanes waits until the sender transmitted (or dropped) everything queued
     void flushBuffer();
 
     /// Enables metric buffering
     /// \param size
     void batchOf(const std::size_t size = 32);
 
+    /// Enables metric buffering with batch size and flush interval adapted to transmission latency (AIMD):
+    /// full batches sent within target latency grow the batch size, slower or failed ones halve it.
+    /// A background thread flushes a partial batch once the interval (twice the recent transmission time,
+    /// up to maxInterval) passed since its first point; its failures are counted in Stats::failed.
+    /// Chosen values are reported in Stats. Call before writing.
+    /// \param minSize         smallest (and initial) batch size
+    /// \param maxSize         largest batch size
+    /// \param targetLatency   transmission time not to exceed
+    /// \param maxInterval     longest wait of a buffered point for its batch to fill
+    void adaptiveBatching(std::size_t minSize, std::size_t maxSize, std::chrono::milliseconds targetLatency,
+      std::chrono::milliseconds maxInterval = std::chrono::seconds(1));
+
+    /// Compacts each flushed batch: points are grouped by series and time, points overwritten within the batch
+    /// (same series and timestamp) are merged into one, later field values winning
+    /// \param enable
+    void compactBatches(bool enable = true);
+
+    /// Replays line protocol file (eg. recorded by the file:// transport) over the transport
+    /// \param path        plain or gzip compressed file
+    /// \param chunkSize   maximum size of a single transmission (keep below datagram size for UDP)
+    void replay(const std::string& path, std::size_t chunkSize = 1024 * 1024);
+
+    /// Sets timestamp precision of written points (default: nanoseconds)
+    /// Coarser precision shortens each line; the transport is informed so the server interprets timestamps correctly.
+    /// Call before writing.
+    /// \param precision
+    void setPrecision(Precision precision);
+
+    /// Omits timestamps of all written points, the server assigns receive time
+    /// (construct points with TimestampSource::Server to skip the clock read as well)
+    /// \param enable
+    void serverTimestamps(bool enable = true);
+
     /// Adds a global tag
     /// \param name
     /// \param value
     void addGlobalTag(std::string_view name, std::string_view value);
 
   private:
-    /// Buffer for points
-    std::deque<std::string> mBuffer;
+    /// Buffer for points, serialized at flush
+    std::deque<Point> mBuffer;
+
+    /// Approximate line protocol size of buffered points
+    std::size_t mBufferBytes;
 
     /// Flag stating whether point buffering is enabled
     bool mBuffering;
@@ -61,14 +237,141 @@ class InfluxDB
     /// Buffer size
     std::size_t mBufferSize;
 
+    /// Adaptive batch size and flush interval (null when disabled)
+    std::unique_ptr<BatchTuner> mTuner;
+
+    /// When the first buffered point was written (adaptive batching)
+    std::chrono::steady_clock::time_point mBufferStart;
+
+    /// Whether batches are compacted at flush
+    bool mCompaction;
+
     /// Underlying transport UDP/HTTP/Unix socket
     std::unique_ptr<Transport> mTransport;
 
     /// Transmits string over transport
-    void transmit(std::string&& point);
+    /// \param start   receives time the transmission started, once previous ones completed (optional)
+    void transmit(std::string&& point, std::chrono::steady_clock::time_point* start = nullptr);
+
+    /// Buffers or transmits metric if it fits memory budget
+    /// \param block        whether to wait for memory (Backpressure::Block only)
+    /// \param inlineFlush  whether own buffer may be transmitted on this thread to release memory
+    bool enqueue(Point&& metric, bool block, bool inlineFlush, Priority priority);
+
+    /// Reserves memory for pending bytes, flushing own buffer or shedding lower priorities first; lock held
+    bool reserve(std::unique_lock<std::mutex>& lock, std::size_t size, bool block, bool inlineFlush, Priority priority);
+
+    /// \return whether point is kept by sampling; lock held
+    bool sample();
+
+    /// Drops oldest queued data of the lowest lane below priority; lock held
+    /// \return false if there is none
+    bool shed(Priority priority);
+
+    /// Serializes points (compacting them if enabled)
+    std::string serialize(const std::deque<Point>& batch, std::size_t size);
+
+    /// Transmits due batches of priority lanes until stopped
+    void send();
+
+    /// Transmits buffer with the lock released
+    void flush(std::unique_lock<std::mutex>& lock);
+
+    /// Flushes partial batches once their interval passed until stopped (adaptive batching)
+    void flushPartial();
+
+    /// Serializes and transmits points, then releases their memory
+    void transmitBatch(std::deque<Point>&& batch, std::size_t size);
+
+    /// Releases memory of transmitted bytes
+    void release(std::size_t size);
+
+    /// Feeds transmission started at start to adaptive batching
+    void tune(std::size_t points, std::chrono::steady_clock::time_point start, bool failed);
+
+    /// Guards buffer, memory accounting and statistics
+    mutable std::mutex mWriteMutex;
+
+    /// Serializes transmissions
+    std::mutex mTransmitMutex;
+
+    /// Signals released memory
+    std::condition_variable mReleased;
+
+    /// Memory budget in bytes (0 - unlimited)
+    std::size_t mBudget;
+
+    /// Behaviour when budget exhausted
+    Backpressure mBackpressure;
+
+    /// Maximum blocking time
+    std::chrono::milliseconds mTimeout;
+
+    /// Sampled points counter
+    std::size_t mSampleCounter;
+
+    /// Statistics
+    Stats mStats;
+
+    /// Queue of a priority
+    struct LaneQueue
+    {
+      Lane settings;
+      std::deque<Point> buffer;
+      std::size_t bytes = 0;                            ///< reserved bytes of buffered points
+      std::chrono::steady_clock::time_point deadline;   ///< when the oldest buffered point is due
+      std::string retry;                                ///< failed batch waiting for retransmission
+      std::size_t retryBytes = 0;                       ///< reserved bytes of the failed batch
+      std::size_t retryPoints = 0;
+      unsigned attempts = 0;                            ///< failed transmissions of the retried batch
+      std::chrono::steady_clock::time_point retryAt;
+      int credit = 0;                                   ///< smooth weighted round robin state
+    };
+
+    /// Queues of each priority (indexed by Priority)
+    std::array<LaneQueue, 3> mLanes;
+
+    /// Whether priority lanes are enabled
+    bool mLaneMode;
+
+    /// Whether the sender shall exit
+    bool mStopping;
+
+    /// Requested flushes of partial batches
+    std::size_t mFlushing;
+
+    /// Whether the partial batch flusher shall transmit the buffer before it is due (memory budget exhausted)
+    bool mFlushRequested;
+
+    /// Batches being transmitted by the sender
+    std::size_t mInFlight;
+
+    /// Transmissions of writeAsync() not completed yet
+    std::size_t mAsyncWrites;
+
+    /// Wakes the sender
+    std::condition_variable mWake;
+
+    /// Background sender of priority lanes, or partial batch flusher of adaptive batching
+    std::thread mSender;
 
     /// List of global tags
     std::string mGlobalTags;
+
+    /// Timestamp precision
+    Precision mPrecision;
+
+    /// Whether timestamps are left to the server
+    bool mServerTimestamps;
+
+    /// Query result cache (null when disabled)
+    std::unique_ptr<QueryCache> mQueryCache;
+
+    /// Tag keys of queried measurements, shared with pending asynchronous queries
+    std::shared_ptr<TagKeys> mTagKeys;
+
+    /// Series limit (null when disabled)
+    std::unique_ptr<CardinalityGuard> mCardinalityGuard;
 };
 
 } // namespace influxdb
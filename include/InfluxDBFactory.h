@@ -5,6 +5,9 @@
 #ifndef INFLUXDATA_INFLUXDB_FACTORY_H
 #define INFLUXDATA_INFLUXDB_FACTORY_H
 
+#include <string>
+#include <vector>
+
 #include "InfluxDB.h"
 #include "Transport.h"
 
@@ -26,11 +29,26 @@ class InfluxDBFactory
    /// \param url 	URL defining transport details
    /// \throw InfluxDBException 	if unrecognised backend or missing protocol
    static std::unique_ptr<InfluxDB> Get(std::string url) noexcept(false);
-  
- private:
+
+   /// InfluxDB factory
+   /// Provides InfluxDB instance distributing series over several backends (consistent hash of series key)
+   /// \param urls 	URLs of shards
+   /// \throw InfluxDBException 	if no URL provided, unrecognised backend, missing protocol or conflicting precision
+   static std::unique_ptr<InfluxDB> GetSharded(const std::vector<std::string>& urls) noexcept(false);
+
+   /// InfluxDB factory
+   /// Provides InfluxDB instance delivering every point to all backends, each one through its own queue
+   /// \param urls 	URLs of replicas
+   /// \throw InfluxDBException 	if no URL provided, unrecognised backend, missing protocol or conflicting precision
+   static std::unique_ptr<InfluxDB> GetReplicated(const std::vector<std::string>& urls) noexcept(false);
+
+   /// Transport factory (eg. for relaying raw line protocol)
    ///\return  backend based on provided URL
+   /// \throw InfluxDBException 	if unrecognised backend or missing protocol
    static std::unique_ptr<Transport> GetTransport(std::string url);
 
+ private:
+
    /// Private constructor disallows to create instance of Factory
    InfluxDBFactory() = default;
 };
@@ -0,0 +1,112 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_LINEPROTOCOLPARSER_H
+#define INFLUXDATA_LINEPROTOCOLPARSER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace influxdb
+{
+
+/// \brief Zero-copy line protocol parser
+/// Records refer to the parsed buffer (names and string values are left escaped, see Unescape),
+/// so the buffer must outlive them. Structural characters are located 16 bytes at a time (SSE2).
+class LineProtocolParser
+{
+  public:
+    /// Tag of a record
+    struct Tag
+    {
+      std::string_view key;
+      std::string_view value;
+    };
+
+    /// Type of field value
+    enum class FieldType { Float, Integer, Unsigned, Boolean, String };
+
+    /// Field of a record
+    struct Field
+    {
+      std::string_view key;
+      FieldType type;
+      std::string_view string;  ///< string value without quotes (still escaped), or text of other values
+      union
+      {
+        double floatValue;
+        long long int integerValue;
+        unsigned long long int unsignedValue;
+        bool booleanValue;
+      };
+    };
+
+    /// Parsed line
+    struct Record
+    {
+      std::string_view line;         ///< whole line (without line terminator), eg. to re-emit it
+      std::string_view measurement;
+      std::vector<Tag> tags;
+      std::vector<Field> fields;
+      bool hasTimestamp;
+      long long int timestamp;       ///< in precision of the data
+    };
+
+    /// Read-only memory mapping of a file
+    class MappedFile
+    {
+      public:
+        /// \throw InfluxDBException	if file cannot be opened or mapped
+        MappedFile(const std::string& path);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /// \return content of the file
+        std::string_view data() const;
+
+      private:
+        void* mAddress;
+        std::size_t mSize;
+    };
+
+    /// \param data   line protocol, lines separated by '\n' (or "\r\n"); blank lines and # comments are skipped
+    LineProtocolParser(std::string_view data);
+
+    /// Parses next line into record (its tags and fields vectors are reused)
+    /// \return false when no lines are left
+    /// \throw InfluxDBException (std::runtime_error)	on malformed line, the parser continues with the next line
+    bool next(Record& record);
+
+    /// \return number of the last parsed line (1 based)
+    std::size_t lineNumber() const;
+
+    /// Removes escaping backslashes (before comma, equals sign, space, double quote and backslash)
+    static std::string Unescape(std::string_view escaped);
+
+  private:
+    /// Parses line (without terminator) into record
+    void parse(const char* begin, const char* end, Record& record);
+
+    /// Parses unquoted field value
+    void parseValue(std::string_view text, Field& field);
+
+    /// Throws error of current line
+    [[noreturn]] void fail(const std::string& message) const;
+
+    /// Unparsed data
+    const char* mPosition;
+
+    /// End of data
+    const char* mEnd;
+
+    /// Current line number
+    std::size_t mLineNumber;
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_LINEPROTOCOLPARSER_H
@@ -0,0 +1,70 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_MEMORY_H
+#define INFLUXDATA_TRANSPORTS_MEMORY_H
+
+#include "Transport.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief In-memory ring buffer transport, keeps last "capacity" messages
+/// Named rings are shared process-wide so that messages sent by an instance obtained from
+/// InfluxDBFactory (memory://name) can be read back with the static accessors
+class Memory : public Transport
+{
+  public:
+    /// Constructor
+    /// \param name       ring name, empty for a private ring
+    /// \param capacity   maximum number of messages kept; used only when the ring is created
+    Memory(const std::string& name = "", std::size_t capacity = 1024);
+
+    /// Default destructor
+    ~Memory() = default;
+
+    /// Appends message to the ring, overwrites the oldest one when full
+    void send(std::string&& message) override;
+
+    /// \return copy of stored messages, oldest first
+    std::vector<std::string> read() const;
+
+    /// \return stored messages, oldest first, and empties the ring
+    std::vector<std::string> drain();
+
+    /// \return number of messages overwritten before being read
+    std::size_t dropped() const override;
+
+    /// Reads named ring
+    /// \throw InfluxDBException	if ring does not exist
+    static std::vector<std::string> Read(const std::string& name);
+
+    /// Drains named ring
+    /// \throw InfluxDBException	if ring does not exist
+    static std::vector<std::string> Drain(const std::string& name);
+
+    /// Removes named ring from the registry
+    static void Release(const std::string& name);
+
+    /// Opaque ring storage
+    struct Ring;
+
+  private:
+    /// Underlying (possibly shared) ring
+    std::shared_ptr<Ring> mRing;
+
+    /// Finds named ring
+    static std::shared_ptr<Ring> Find(const std::string& name);
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_MEMORY_H
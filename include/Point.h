@@ -6,33 +6,109 @@
 #define INFLUXDATA_POINT_H
 
 #include <string>
+#include <string_view>
 #include <chrono>
-#include <variant>
 
 namespace influxdb
 {
 
+class TimestampFormatter;
+
+/// \brief Timestamp precision
+enum class Precision
+{
+  Seconds,
+  Milliseconds,
+  Microseconds,
+  Nanoseconds
+};
+
+/// \brief Source of point timestamp
+enum class TimestampSource
+{
+  /// System clock read at construction
+  System,
+  /// CoarseClock (cached time, no clock read)
+  Coarse,
+  /// No timestamp, server assigns receive time
+  Server
+};
+
 /// \brief Represents a point
 class Point
 {
   public:
     /// Constructs point based on measurement name
-    Point(const std::string& measurement);
+    /// \param source   where timestamp comes from
+    Point(const std::string& measurement, TimestampSource source = TimestampSource::System);
 
     /// Default destructor
     ~Point() = default;
 
+    /// Default copy constructor
+    Point(const Point&) = default;
+
+    /// Default move constructor
+    Point(Point&&) = default;
+
+    /// Default copy assignment
+    Point& operator=(const Point&) = default;
+
+    /// Default move assignment
+    Point& operator=(Point&&) = default;
+
     /// Adds a tags
     Point&& addTag(std::string_view key, std::string_view value);
 
-    /// Adds filed
-    Point&& addField(std::string_view name, std::variant<int, long long int, std::string, double> value);
+    /// Adds boolean field
+    Point&& addField(std::string_view name, bool value);
+
+    /// Adds integer field
+    Point&& addField(std::string_view name, int value);
+
+    /// Adds integer field
+    Point&& addField(std::string_view name, long int value);
+
+    /// Adds integer field
+    Point&& addField(std::string_view name, long long int value);
+
+    /// Adds unsigned integer field
+    Point&& addField(std::string_view name, unsigned int value);
+
+    /// Adds unsigned integer field
+    Point&& addField(std::string_view name, unsigned long int value);
+
+    /// Adds unsigned integer field
+    Point&& addField(std::string_view name, unsigned long long int value);
+
+    /// Adds float field
+    Point&& addField(std::string_view name, double value);
+
+    /// Adds string field (quotes and backslashes are escaped)
+    Point&& addField(std::string_view name, std::string_view value);
+
+    /// Adds string field (prevents string literals from being converted to bool)
+    Point&& addField(std::string_view name, const char* value);
 
     /// Generetes current timestamp
     static auto getCurrentTimestamp() -> decltype(std::chrono::system_clock::now());
 
     /// Converts point to Influx Line Protocol
-    std::string toLineProtocol() const;
+    /// \param precision   timestamp precision, has to match the one the server expects
+    std::string toLineProtocol(Precision precision = Precision::Nanoseconds) const;
+
+    /// Appends newline terminated line protocol to a batch
+    /// \param formatter   renders timestamps incrementally across the batch
+    void appendLineProtocol(std::string& out, TimestampFormatter& formatter, Precision precision) const;
+
+    /// \return approximate size of line protocol representation
+    std::size_t size() const;
+
+    /// Removes timestamp, the server assigns receive time
+    Point&& removeTimestamp();
+
+    /// \return whether point carries a timestamp
+    bool hasTimestamp() const;
 
     /// Sets custom timestamp
     Point&& setTimestamp(std::chrono::time_point<std::chrono::system_clock> timestamp);
@@ -40,7 +116,7 @@ class Point
     /// Name getter
     std::string getName() const;
 
-    /// Timestamp getter
+    /// Timestamp getter (epoch when point has no timestamp)
     std::chrono::time_point<std::chrono::system_clock> getTimestamp() const;
 
     /// Fields getter
@@ -49,9 +125,23 @@ class Point
     /// Tags getter
     std::string getTags() const;
 
+    /// \return measurement name without copying
+    std::string_view getNameView() const;
+
+    /// \return tags as serialized (",key=value,...") without copying
+    std::string_view getTagsView() const;
+
+    /// Replaces value of a tag
+    /// \return false if point has no such tag
+    bool replaceTag(std::string_view key, std::string_view value);
+
   protected:
-    /// A value
-    std::variant<long long int, std::string, double> mValue;
+    /// Appends field name and separator
+    void beginField(std::string_view name);
+
+    /// Appends integer field value with type suffix
+    template<typename T>
+    Point&& addIntegerField(std::string_view name, T value, char suffix);
 
     /// A name
     std::string mMeasurement;
@@ -59,6 +149,9 @@ class Point
     /// A timestamp
     std::chrono::time_point<std::chrono::system_clock> mTimestamp;
 
+    /// Whether timestamp is serialized
+    bool mHasTimestamp;
+
     /// Tags
     std::string mTags;
 
@@ -5,9 +5,14 @@
 #ifndef INFLUXDATA_TRANSPORTINTERFACE_H
 #define INFLUXDATA_TRANSPORTINTERFACE_H
 
+#include <exception>
+#include <functional>
+#include <memory>
 #include <string>
 #include <stdexcept>
 
+#include "Point.h"
+
 namespace influxdb
 {
 
@@ -22,10 +27,67 @@ class Transport
     /// Sends string blob
     virtual void send(std::string&& message) = 0;
 
+    /// Sends immutable blob shared with other transports (copies it into send() unless overridden)
+    virtual void sendShared(const std::shared_ptr<const std::string>& message) {
+      send(std::string(*message));
+    }
+
+    /// Receives result of a send, error is null on success
+    using SendHandler = std::function<void(std::exception_ptr error)>;
+
+    /// Sends string blob without waiting for delivery; handler may be called from another thread
+    /// (runs send() in the calling thread unless overridden)
+    virtual void sendAsync(std::string&& message, SendHandler handler) {
+      try {
+        send(std::move(message));
+      } catch (...) {
+        handler(std::current_exception());
+        return;
+      }
+      handler(nullptr);
+    }
+
+    /// Informs transport about timestamp precision of sent data (eg. to pass it to the server)
+    virtual void setPrecision(Precision /*precision*/) {}
+
+    /// \return number of messages discarded without an error reported to the sender (eg. queue full)
+    virtual std::size_t dropped() const { return 0; }
+
+    /// \return number of messages that failed to be delivered in background, without an error reported to the sender
+    virtual std::size_t failed() const { return 0; }
+
+    /// Receives query response, or error when the query failed
+    using QueryHandler = std::function<void(std::string&& response, std::exception_ptr error)>;
+
     /// Sends s request
     virtual std::string query(const std::string& /*query*/) {
       throw std::runtime_error("Queries are not supported in the selected transport");
     }
+
+    /// Sends a request without waiting for the response; handler may be called from another thread
+    /// (runs query() in the calling thread unless overridden)
+    virtual void queryAsync(const std::string& query, QueryHandler handler) {
+      std::string response;
+      try {
+        response = this->query(query);
+      } catch (...) {
+        handler({}, std::current_exception());
+        return;
+      }
+      handler(std::move(response), nullptr);
+    }
+
+    /// Receives consecutive parts of a streamed response, the last one flagged; an error ends the stream
+    using ChunkHandler = std::function<void(std::string&& chunk, bool last, std::exception_ptr error)>;
+
+    /// Sends a request whose response is streamed in chunks of at most chunkSize rows, each passed to handler
+    /// as a complete response once received; handler may be called from another thread
+    /// (passes the whole queryAsync() response as the last chunk unless overridden)
+    virtual void queryChunked(const std::string& query, std::size_t /*chunkSize*/, ChunkHandler handler) {
+      queryAsync(query, [handler = std::move(handler)](std::string&& response, std::exception_ptr error) {
+        handler(std::move(response), true, error);
+      });
+    }
 };
 
 } // namespace influxdb
@@ -0,0 +1,68 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "BatchTuner.h"
+
+#include <algorithm>
+
+namespace influxdb
+{
+
+BatchTuner::BatchTuner(std::size_t minSize, std::size_t maxSize, std::chrono::milliseconds target,
+  std::chrono::milliseconds maxInterval) :
+  mMinSize(std::max<std::size_t>(1, minSize)), mMaxSize(std::max(mMinSize, maxSize)), mTarget(target),
+  mMaxInterval(maxInterval), mSize(mMinSize), mInterval(maxInterval), mSamples{}, mRecorded(0)
+{
+  // the whole range is covered in about 32 transmissions
+  mStep = (mMaxSize - mMinSize) / 32 + 1;
+}
+
+void BatchTuner::record(std::size_t points, std::chrono::nanoseconds latency, bool failed)
+{
+  mSamples[mRecorded++ % Window] = {points, latency};
+  if (failed || latency > mTarget) {
+    mSize = std::max(mMinSize, mSize / 2);
+  } else if (points >= mSize) {
+    mSize = std::min(mMaxSize, mSize + mStep);
+  }
+  auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(2 * BatchTuner::latency());
+  mInterval = std::clamp(interval, std::min(std::chrono::milliseconds(1), mMaxInterval), mMaxInterval);
+}
+
+std::size_t BatchTuner::size() const
+{
+  return mSize;
+}
+
+std::chrono::milliseconds BatchTuner::interval() const
+{
+  return mInterval;
+}
+
+std::chrono::microseconds BatchTuner::latency() const
+{
+  auto count = std::min(mRecorded, Window);
+  if (count == 0) {
+    return {};
+  }
+  std::chrono::nanoseconds total{0};
+  for (std::size_t i = 0; i < count; i++) {
+    total += mSamples[i].latency;
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(total / count);
+}
+
+double BatchTuner::throughput() const
+{
+  auto count = std::min(mRecorded, Window);
+  std::size_t points = 0;
+  std::chrono::nanoseconds total{0};
+  for (std::size_t i = 0; i < count; i++) {
+    points += mSamples[i].points;
+    total += mSamples[i].latency;
+  }
+  return total.count() > 0 ? points / std::chrono::duration<double>(total).count() : 0;
+}
+
+} // namespace influxdb
@@ -0,0 +1,83 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_BATCHTUNER_H
+#define INFLUXDATA_BATCHTUNER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace influxdb
+{
+
+/// \brief Chooses batch size and flush interval from observed transmission latency (AIMD)
+/// A full batch transmitted within the target latency grows the batch size additively, a slower or failed
+/// transmission halves it; the size settles around the largest batches the server takes within the target.
+/// Partial batches are flushed after twice the average transmission time (a sooner flush would only queue
+/// behind the transmission in progress), within bounds.
+class BatchTuner
+{
+  public:
+    /// Constructor
+    /// \param minSize        smallest batch size, also the initial one
+    /// \param maxSize        largest batch size
+    /// \param target         transmission latency not to exceed
+    /// \param maxInterval    longest time a point waits for its batch to fill
+    BatchTuner(std::size_t minSize, std::size_t maxSize, std::chrono::milliseconds target,
+      std::chrono::milliseconds maxInterval);
+
+    /// Records transmission of a batch and adjusts settings
+    /// \param points    points in the batch
+    /// \param latency   transmission time
+    /// \param failed    whether transmission failed
+    void record(std::size_t points, std::chrono::nanoseconds latency, bool failed);
+
+    /// \return current batch size
+    std::size_t size() const;
+
+    /// \return current flush interval
+    std::chrono::milliseconds interval() const;
+
+    /// \return average transmission time over the window
+    std::chrono::microseconds latency() const;
+
+    /// \return points per second of transmission time over the window
+    double throughput() const;
+
+  private:
+    /// Number of recent transmissions averaged
+    static constexpr std::size_t Window = 8;
+
+    /// Recent transmission
+    struct Sample
+    {
+      std::size_t points;
+      std::chrono::nanoseconds latency;
+    };
+
+    std::size_t mMinSize;
+    std::size_t mMaxSize;
+    std::chrono::nanoseconds mTarget;
+    std::chrono::milliseconds mMaxInterval;
+
+    /// Additive increase step
+    std::size_t mStep;
+
+    /// Current batch size
+    std::size_t mSize;
+
+    /// Current flush interval
+    std::chrono::milliseconds mInterval;
+
+    /// Ring of recent transmissions
+    std::array<Sample, Window> mSamples;
+
+    /// Number of recorded transmissions
+    std::size_t mRecorded;
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_BATCHTUNER_H
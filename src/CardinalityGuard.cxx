@@ -0,0 +1,162 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "CardinalityGuard.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace influxdb
+{
+
+namespace
+{
+
+/// Calls visitor with key and value of each tag of serialized tags (",key=value,...")
+template<typename Visitor>
+void forEachTag(std::string_view tags, Visitor visitor)
+{
+  std::size_t position = 0;
+  while (position < tags.size()) {
+    auto keyBegin = position + 1;
+    auto end = std::min(tags.find(',', keyBegin), tags.size());
+    auto separator = tags.find('=', keyBegin);
+    if (separator < end) {
+      visitor(tags.substr(keyBegin, separator - keyBegin), tags.substr(separator + 1, end - separator - 1));
+    }
+    position = end;
+  }
+}
+
+} // namespace
+
+CardinalityGuard::CardinalityGuard(std::size_t limit, CardinalityPolicy policy) :
+  mLimit(limit), mPolicy(policy), mLimited(0)
+{
+}
+
+CardinalityGuard::Measurement* CardinalityGuard::find(std::uint64_t key) const
+{
+  for (auto measurement = mBuckets[key % Buckets].load(std::memory_order_acquire); measurement != nullptr;
+    measurement = measurement->next) {
+    if (measurement->key == key) return measurement;
+  }
+  return nullptr;
+}
+
+HyperLogLog* CardinalityGuard::tag(const Measurement& measurement, std::string_view key)
+{
+  for (auto tag = measurement.tags.load(std::memory_order_acquire); tag != nullptr; tag = tag->next) {
+    if (tag->key == key) return &tag->values;
+  }
+  return nullptr;
+}
+
+CardinalityGuard::Measurement& CardinalityGuard::count(std::uint64_t key, std::string_view tags)
+{
+  auto measurement = find(key);
+  if (measurement) {
+    bool known = true;
+    forEachTag(tags, [&](std::string_view tagKey, std::string_view value) {
+      auto counter = tag(*measurement, tagKey);
+      if (counter) {
+        counter->add(hash64(value));
+      } else {
+        known = false;
+      }
+    });
+    if (known) {
+      return *measurement;
+    }
+  }
+  // new measurement or tag key, counting values again is harmless
+  std::lock_guard<std::mutex> lock(mMutex);
+  measurement = find(key);
+  if (!measurement) {
+    auto& bucket = mBuckets[key % Buckets];
+    measurement = &mStorage.emplace_back(key);
+    measurement->next = bucket.load(std::memory_order_relaxed);
+    bucket.store(measurement, std::memory_order_release);
+  }
+  forEachTag(tags, [&](std::string_view tagKey, std::string_view value) {
+    auto counter = tag(*measurement, tagKey);
+    if (!counter) {
+      auto& added = measurement->storage.emplace_back(tagKey);
+      added.next = measurement->tags.load(std::memory_order_relaxed);
+      measurement->tags.store(&added, std::memory_order_release);
+      counter = &added.values;
+    }
+    counter->add(hash64(value));
+  });
+  return *measurement;
+}
+
+void CardinalityGuard::exceed(Measurement& measurement)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (measurement.exceeded.load(std::memory_order_relaxed)) {
+    return;
+  }
+  double highest = 0;
+  for (const auto& tag : measurement.storage) {
+    auto estimate = tag.values.estimate();
+    if (estimate > highest) {
+      highest = estimate;
+      measurement.offending = tag.key;
+    }
+  }
+  // offending key is immutable from now on and read without lock
+  measurement.exceeded.store(true, std::memory_order_release);
+}
+
+bool CardinalityGuard::admit(Point& point)
+{
+  auto key = hash64(point.getNameView());
+  auto tags = point.getTagsView();
+  auto& measurement = count(key, tags);
+  // estimate changes only when a register grows, which gets rare as the counter fills up
+  if (measurement.series.add(hash64(tags, key)) && !measurement.exceeded.load(std::memory_order_relaxed)
+    && measurement.series.estimate() > mLimit) {
+    exceed(measurement);
+  }
+  if (!measurement.exceeded.load(std::memory_order_acquire) || measurement.offending.empty()) {
+    return true;
+  }
+
+  if (mPolicy == CardinalityPolicy::Rewrite) {
+    if (point.replaceTag(measurement.offending, Overflow)) {
+      mLimited.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+  }
+  bool offending = false;
+  forEachTag(tags, [&](std::string_view key, std::string_view) {
+    offending = offending || key == measurement.offending;
+  });
+  if (!offending) {
+    return true;
+  }
+  if (mPolicy == CardinalityPolicy::Sample
+    && measurement.sampled.fetch_add(1, std::memory_order_relaxed) % SampleRate == 0) {
+    return true;
+  }
+  mLimited.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+std::size_t CardinalityGuard::estimate(std::string_view measurement) const
+{
+  auto found = find(hash64(measurement));
+  if (!found) {
+    return 0;
+  }
+  return static_cast<std::size_t>(std::llround(found->series.estimate()));
+}
+
+std::size_t CardinalityGuard::limited() const
+{
+  return mLimited.load(std::memory_order_relaxed);
+}
+
+} // namespace influxdb
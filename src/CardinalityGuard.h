@@ -0,0 +1,127 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_CARDINALITYGUARD_H
+#define INFLUXDATA_CARDINALITYGUARD_H
+
+#include "HyperLogLog.h"
+#include "InfluxDB.h"
+#include "Point.h"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace influxdb
+{
+
+/// \brief Limits distinct series written per measurement
+/// Series and values of each tag key are counted per measurement with HyperLogLog. Once a measurement exceeds
+/// the limit, its tag key with most distinct values is taken as the offending one and points carrying it are
+/// dropped, sampled or get its value rewritten. Measurements and tag keys are never removed, so they are kept in
+/// append-only lists read without locking; only adding a measurement or tag key takes a lock.
+class CardinalityGuard
+{
+  public:
+    /// Value of the offending tag with CardinalityPolicy::Rewrite
+    static constexpr std::string_view Overflow = "_overflow";
+
+    /// Points of the offending tag kept with CardinalityPolicy::Sample (1 of SampleRate)
+    static constexpr std::size_t SampleRate = 16;
+
+    /// Constructor
+    /// \param limit   distinct series per measurement
+    CardinalityGuard(std::size_t limit, CardinalityPolicy policy);
+
+    /// Counts series of the point and applies policy if its measurement exceeds the limit
+    /// \return false if point has to be dropped
+    bool admit(Point& point);
+
+    /// \return estimated distinct series of measurement
+    std::size_t estimate(std::string_view measurement) const;
+
+    /// \return points dropped, sampled out or rewritten
+    std::size_t limited() const;
+
+  private:
+    /// Values counter of a tag key
+    struct Tag
+    {
+      explicit Tag(std::string_view key) : key(key) {}
+
+      std::string key;
+      HyperLogLog values;
+
+      /// Previously added tag key of the measurement, immutable once published
+      Tag* next = nullptr;
+    };
+
+    /// Counters of a measurement
+    struct Measurement
+    {
+      explicit Measurement(std::uint64_t key) : key(key) {}
+
+      /// Hash of measurement name
+      std::uint64_t key;
+
+      HyperLogLog series;
+
+      /// Most recently added tag key, published with release
+      std::atomic<Tag*> tags{nullptr};
+
+      /// Storage of tag keys (stable addresses), appended under lock
+      std::deque<Tag> storage;
+
+      /// Whether limit was exceeded
+      std::atomic<bool> exceeded{false};
+
+      /// Tag key with most distinct values, set under lock once limit is exceeded
+      std::string offending;
+
+      /// Points of the offending tag seen by sampling
+      std::atomic<std::size_t> sampled{0};
+
+      /// Previously added measurement of the same bucket, immutable once published
+      Measurement* next = nullptr;
+    };
+
+    /// Number of measurement buckets
+    static constexpr std::size_t Buckets = 256;
+
+    /// Counts values of each tag, creating missing counters
+    /// \param key   hash of measurement name
+    /// \return counters of measurement
+    Measurement& count(std::uint64_t key, std::string_view tags);
+
+    /// \return counters of measurement, null if missing
+    Measurement* find(std::uint64_t key) const;
+
+    /// \return value counter of tag key, null if missing
+    static HyperLogLog* tag(const Measurement& measurement, std::string_view key);
+
+    /// Picks the offending tag key once limit is exceeded
+    void exceed(Measurement& measurement);
+
+    std::size_t mLimit;
+    CardinalityPolicy mPolicy;
+
+    /// Most recently added measurement of each bucket (by hash of name), published with release
+    std::array<std::atomic<Measurement*>, Buckets> mBuckets{};
+
+    /// Storage of measurements (stable addresses), appended under lock
+    std::deque<Measurement> mStorage;
+
+    /// Serializes adding measurements and tag keys, and picking offending keys
+    std::mutex mMutex;
+
+    /// Points dropped, sampled out or rewritten
+    std::atomic<std::size_t> mLimited;
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_CARDINALITYGUARD_H
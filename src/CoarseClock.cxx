@@ -0,0 +1,73 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "CoarseClock.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace influxdb
+{
+
+namespace
+{
+/// Tick thread keeping cached time
+class Ticker
+{
+  public:
+    Ticker() : mResolution(10), mStop(false) {
+      mTime = tick();
+      mThread = std::thread([this] {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (!mCondition.wait_for(lock, std::chrono::milliseconds(mResolution.load()), [this] { return mStop; })) {
+          mTime.store(tick(), std::memory_order_relaxed);
+        }
+      });
+    }
+
+    ~Ticker() {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+      }
+      mCondition.notify_one();
+      mThread.join();
+    }
+
+    static std::chrono::system_clock::rep tick() {
+      return std::chrono::system_clock::now().time_since_epoch().count();
+    }
+
+    std::atomic<std::chrono::system_clock::rep> mTime;
+    std::atomic<long> mResolution;
+
+  private:
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStop;
+    std::thread mThread;
+};
+
+Ticker& ticker()
+{
+  static Ticker instance;
+  return instance;
+}
+} // namespace
+
+std::chrono::time_point<std::chrono::system_clock> CoarseClock::now()
+{
+  return std::chrono::time_point<std::chrono::system_clock>(
+    std::chrono::system_clock::duration(ticker().mTime.load(std::memory_order_relaxed))
+  );
+}
+
+void CoarseClock::setResolution(std::chrono::milliseconds resolution)
+{
+  ticker().mResolution = resolution.count() > 0 ? resolution.count() : 1;
+}
+
+} // namespace influxdb
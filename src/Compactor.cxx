@@ -0,0 +1,128 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "Compactor.h"
+#include "InfluxDBException.h"
+#include "LineProtocolParser.h"
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace influxdb
+{
+
+namespace
+{
+
+/// Line with its sort key
+struct Entry
+{
+  std::string_view series;
+  bool hasTimestamp;
+  long long int timestamp;
+  std::string_view line;
+};
+
+bool samePoint(const Entry& left, const Entry& right)
+{
+  return left.series == right.series && left.hasTimestamp == right.hasTimestamp && left.timestamp == right.timestamp;
+}
+
+/// \return measurement and tags of parsed line
+std::string_view seriesOf(const LineProtocolParser::Record& record)
+{
+  auto end = record.tags.empty() ? record.measurement.data() + record.measurement.size()
+    : record.tags.back().value.data() + record.tags.back().value.size();
+  return {record.line.data(), static_cast<std::size_t>(end - record.line.data())};
+}
+
+/// \return field value as written (string values with quotes)
+std::string_view rawValue(const LineProtocolParser::Field& field)
+{
+  if (field.type == LineProtocolParser::FieldType::String) {
+    return {field.string.data() - 1, field.string.size() + 2};
+  }
+  return field.string;
+}
+
+/// Appends single line merged from lines of the same point, in order of writing
+void merge(std::vector<Entry>::const_iterator first, std::vector<Entry>::const_iterator last, std::string& out)
+{
+  std::vector<std::pair<std::string_view, std::string_view>> fields;
+  LineProtocolParser::Record record;
+  for (auto entry = first; entry != last; ++entry) {
+    LineProtocolParser parser(entry->line);
+    parser.next(record);
+    for (const auto& field : record.fields) {
+      auto found = std::find_if(fields.begin(), fields.end(), [&](const auto& merged) {
+        return merged.first == field.key;
+      });
+      if (found != fields.end()) {
+        found->second = rawValue(field);
+      } else {
+        fields.emplace_back(field.key, rawValue(field));
+      }
+    }
+  }
+  out += first->series;
+  char separator = ' ';
+  for (const auto& [key, value] : fields) {
+    out += separator;
+    out += key;
+    out += '=';
+    out += value;
+    separator = ',';
+  }
+  if (first->hasTimestamp) {
+    out += ' ';
+    out += std::to_string(first->timestamp);
+  }
+  out += '\n';
+}
+
+} // namespace
+
+std::size_t Compactor::Compact(std::string& lines)
+{
+  std::vector<Entry> entries;
+  try {
+    LineProtocolParser parser(lines);
+    LineProtocolParser::Record record;
+    while (parser.next(record)) {
+      entries.push_back({seriesOf(record), record.hasTimestamp, record.timestamp, record.line});
+    }
+  } catch (const InfluxDBException&) {
+    return 0;
+  }
+
+  std::stable_sort(entries.begin(), entries.end(), [](const Entry& left, const Entry& right) {
+    if (left.series != right.series) return left.series < right.series;
+    if (left.hasTimestamp != right.hasTimestamp) return right.hasTimestamp;
+    return left.timestamp < right.timestamp;
+  });
+
+  std::string compacted;
+  compacted.reserve(lines.size());
+  std::size_t merged = 0;
+  for (auto first = entries.cbegin(); first != entries.cend();) {
+    auto last = first + 1;
+    while (last != entries.cend() && samePoint(*first, *last)) {
+      ++last;
+    }
+    if (last - first == 1) {
+      compacted += first->line;
+      compacted += '\n';
+    } else {
+      merge(first, last, compacted);
+      merged += last - first - 1;
+    }
+    first = last;
+  }
+  lines.swap(compacted);
+  return merged;
+}
+
+} // namespace influxdb
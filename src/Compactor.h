@@ -0,0 +1,29 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_COMPACTOR_H
+#define INFLUXDATA_COMPACTOR_H
+
+#include <cstddef>
+#include <string>
+
+namespace influxdb
+{
+
+/// \brief Compaction of line protocol batches before transmission
+/// Lines are grouped by series key (measurement and tags as written) and ordered by time, so that the server
+/// receives the points of each series contiguously. Points of a series sharing a timestamp overwrite each other
+/// on the server; they are merged into one line, later values of a field replacing earlier ones. Lines without
+/// timestamp share the receive time of the request, so they are merged per series as well.
+class Compactor
+{
+  public:
+    /// Compacts lines in place, a batch with a malformed line is left untouched
+    /// \return number of lines merged into others
+    static std::size_t Compact(std::string& lines);
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_COMPACTOR_H
@@ -0,0 +1,61 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "CurlShare.h"
+#include "InfluxDBException.h"
+
+namespace influxdb
+{
+namespace transports
+{
+
+CurlShare& CurlShare::Instance()
+{
+  static CurlShare instance;
+  return instance;
+}
+
+CurlShare::CurlShare()
+{
+  CURLcode globalInitResult = curl_global_init(CURL_GLOBAL_ALL);
+  if (globalInitResult != CURLE_OK) {
+    throw InfluxDBException("CurlShare::CurlShare", curl_easy_strerror(globalInitResult));
+  }
+  mShare = curl_share_init();
+  curl_share_setopt(mShare, CURLSHOPT_LOCKFUNC, &CurlShare::lock);
+  curl_share_setopt(mShare, CURLSHOPT_UNLOCKFUNC, &CurlShare::unlock);
+  curl_share_setopt(mShare, CURLSHOPT_USERDATA, this);
+  curl_share_setopt(mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  // connections are not shared: handles run transfers from several threads concurrently, which a shared
+  // connection pool does not support; each easy and multi handle keeps its own connections alive
+}
+
+CurlShare::~CurlShare()
+{
+  curl_share_cleanup(mShare);
+  curl_global_cleanup();
+}
+
+CURL* CurlShare::createHandle()
+{
+  CURL* handle = curl_easy_init();
+  curl_easy_setopt(handle, CURLOPT_SHARE, mShare);
+  // handles are used from several threads, signals cannot be used for DNS timeouts
+  curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+  return handle;
+}
+
+void CurlShare::lock(CURL* /*handle*/, curl_lock_data data, curl_lock_access /*access*/, void* share)
+{
+  static_cast<CurlShare*>(share)->mMutexes[data].lock();
+}
+
+void CurlShare::unlock(CURL* /*handle*/, curl_lock_data data, void* share)
+{
+  static_cast<CurlShare*>(share)->mMutexes[data].unlock();
+}
+
+} // namespace transports
+} // namespace influxdb
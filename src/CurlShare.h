@@ -0,0 +1,58 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_CURLSHARE_H
+#define INFLUXDATA_CURLSHARE_H
+
+#include <curl/curl.h>
+#include <array>
+#include <mutex>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief Process wide cURL state shared by all HTTP transports
+/// Performs curl_global_init once and shares DNS cache and TLS sessions between handles
+class CurlShare
+{
+  public:
+    /// Disables copy constructor
+    CurlShare & operator=(const CurlShare&) = delete;
+
+    /// Disables copy constructor
+    CurlShare(const CurlShare&) = delete;
+
+    /// \return instance, initialized on first use
+    /// \throw InfluxDBException	if cURL cannot be initialized
+    static CurlShare& Instance();
+
+    /// Creates easy handle attached to the shared caches
+    CURL* createHandle();
+
+  private:
+    /// Initializes cURL and share handle
+    CurlShare();
+
+    /// Cleans up share handle and cURL
+    ~CurlShare();
+
+    /// Share lock callback
+    static void lock(CURL* handle, curl_lock_data data, curl_lock_access access, void* share);
+
+    /// Share unlock callback
+    static void unlock(CURL* handle, curl_lock_data data, void* share);
+
+    /// Share handle
+    CURLSH* mShare;
+
+    /// One mutex per shared data type
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> mMutexes;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_CURLSHARE_H
@@ -0,0 +1,260 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_DATAGRAM_H
+#define INFLUXDATA_TRANSPORTS_DATAGRAM_H
+
+#include "IoContext.h"
+#include "InfluxDBException.h"
+
+#include <boost/asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief Datagram socket sending either synchronously or asynchronously on a shared IoContext
+/// In asynchronous mode send() only queues the message; sends of one socket are serialized by a strand,
+/// messages over the limit of pending sends are dropped so that callers never block.
+/// Messages sent before the destination is set (eg. while it is being resolved) are held and sent once it is known.
+template<typename Protocol>
+class Datagram
+{
+  public:
+    /// \param context      shared context for asynchronous sends, synchronous when null
+    /// \param maxPending   maximum number of queued messages (asynchronous mode)
+    Datagram(std::shared_ptr<IoContext> context, std::size_t maxPending = 1024) :
+      mContext(std::move(context)),
+      mSocket(mContext ? mContext->get() : mIoContext),
+      mStrand(boost::asio::make_strand(mContext ? mContext->get() : mIoContext)),
+      mMaxPending(maxPending), mPending(0), mDropped(0)
+    {
+    }
+
+    /// Waits for queued messages to be sent (1 second at most, the rest is abandoned)
+    ~Datagram()
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      if (mDone.wait_for(lock, std::chrono::seconds(1), [this] { return mPending == 0; })) {
+        return;
+      }
+      mPending++;
+      boost::asio::post(mStrand, [this] {
+        boost::system::error_code ignored;
+        mSocket.cancel(ignored);
+        done(nullptr);
+      });
+      mDone.wait(lock, [this] { return mPending == 0; });
+    }
+
+    /// \return resolver, connection and send context
+    boost::asio::io_context& context()
+    {
+      return mContext ? mContext->get() : mIoContext;
+    }
+
+    /// \return socket to be opened by the owner
+    typename Protocol::socket& socket()
+    {
+      return mSocket;
+    }
+
+    /// Sets destination (thread-safe, may change while sending), sends messages held until then
+    void endpoint(const typename Protocol::endpoint& endpoint)
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mEndpoint = endpoint;
+      mHasEndpoint = true;
+      for (auto& message : mEarly) {
+        try {
+          dispatch(message, nullptr, "Datagram::endpoint");
+        } catch (...) {
+          mDropped++;
+        }
+      }
+      mEarly.clear();
+    }
+
+    /// Sends message, takes ownership of it in asynchronous mode;
+    /// messages are held until the destination is known (up to maxPending, more are dropped)
+    void send(std::string&& message, const char* source)
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      if (!mHasEndpoint) {
+        hold(std::make_shared<const std::string>(std::move(message)));
+        return;
+      }
+      dispatch(nullptr, &message, source, &lock);
+    }
+
+    /// Sends shared message, holds a reference to it in asynchronous mode
+    void sendShared(const std::shared_ptr<const std::string>& message, const char* source)
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      if (!mHasEndpoint) {
+        hold(message);
+        return;
+      }
+      dispatch(message, nullptr, source, &lock);
+    }
+
+    /// \return number of messages dropped as the queue was full, or failed to be sent asynchronously
+    std::size_t dropped() const
+    {
+      return mDropped;
+    }
+
+  private:
+    /// Pending message; slots are reused to avoid allocating per send
+    struct Slot
+    {
+      std::string message;
+      std::shared_ptr<const std::string> shared;
+    };
+
+    /// Keeps message until the destination is known; lock held
+    void hold(std::shared_ptr<const std::string> message)
+    {
+      if (mEarly.size() >= mMaxPending) {
+        mDropped++;
+        return;
+      }
+      mEarly.push_back(std::move(message));
+    }
+
+    /// Sends shared or owned message to the current endpoint; lock held, released before a synchronous send
+    void dispatch(const std::shared_ptr<const std::string>& shared, std::string* owned, const char* source,
+      std::unique_lock<std::mutex>* lock = nullptr)
+    {
+      auto endpoint = mEndpoint;
+      if (!mContext) {
+        if (lock) {
+          lock->unlock();
+        }
+        sendTo(shared ? *shared : *owned, endpoint, source);
+        return;
+      }
+      auto slot = acquire();
+      if (!slot) {
+        return;
+      }
+      if (shared) {
+        slot->shared = shared;
+        start(slot, boost::asio::buffer(*shared), endpoint);
+      } else {
+        slot->message = std::move(*owned);
+        start(slot, boost::asio::buffer(slot->message), endpoint);
+      }
+    }
+
+    /// Sends datagram synchronously
+    void sendTo(const std::string& message, const typename Protocol::endpoint& endpoint, const char* source)
+    {
+      try {
+        mSocket.send_to(boost::asio::buffer(message, message.size()), endpoint);
+      } catch(const boost::system::system_error& e) {
+        throw InfluxDBException(source, e.what());
+      }
+    }
+
+    /// \return free slot, null (and message dropped) when too many sends are pending; lock held
+    Slot* acquire()
+    {
+      if (mPending >= mMaxPending) {
+        mDropped++;
+        return nullptr;
+      }
+      mPending++;
+      if (mFree.empty()) {
+        mSlots.push_back(std::make_unique<Slot>());
+        return mSlots.back().get();
+      }
+      auto slot = mFree.back();
+      mFree.pop_back();
+      return slot;
+    }
+
+    /// Initiates send within the strand
+    void start(Slot* slot, boost::asio::const_buffer buffer, const typename Protocol::endpoint& endpoint)
+    {
+      boost::asio::post(mStrand, [this, slot, buffer, endpoint] {
+        mSocket.async_send_to(buffer, endpoint, boost::asio::bind_executor(mStrand,
+          [this, slot](const boost::system::error_code& error, std::size_t) {
+            if (error) {
+              mDropped++;
+            }
+            done(slot);
+          }));
+      });
+    }
+
+    /// Returns slot to the pool
+    void done(Slot* slot)
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (slot) {
+        slot->message.clear();
+        slot->shared.reset();
+        mFree.push_back(slot);
+      }
+      mPending--;
+      mDone.notify_all();
+    }
+
+    /// Own context of synchronous mode (never run)
+    boost::asio::io_context mIoContext;
+
+    /// Shared context of asynchronous mode
+    std::shared_ptr<IoContext> mContext;
+
+    /// Socket
+    typename Protocol::socket mSocket;
+
+    /// Destination
+    typename Protocol::endpoint mEndpoint;
+
+    /// Whether destination is known
+    bool mHasEndpoint = false;
+
+    /// Messages sent before destination was known
+    std::deque<std::shared_ptr<const std::string>> mEarly;
+
+    /// Serializes operations on the socket
+    boost::asio::strand<boost::asio::io_context::executor_type> mStrand;
+
+    /// Guards destination, held messages, slots and pending count
+    std::mutex mMutex;
+
+    /// Notified when a pending send completes
+    std::condition_variable mDone;
+
+    /// All slots
+    std::vector<std::unique_ptr<Slot>> mSlots;
+
+    /// Slots not in use
+    std::vector<Slot*> mFree;
+
+    /// Maximum number of pending sends
+    std::size_t mMaxPending;
+
+    /// Number of pending sends
+    std::size_t mPending;
+
+    /// Number of dropped messages
+    std::atomic<std::size_t> mDropped;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_DATAGRAM_H
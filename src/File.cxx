@@ -0,0 +1,283 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "File.h"
+#include "InfluxDBException.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef INFLUXDB_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace influxdb
+{
+namespace transports
+{
+
+namespace
+{
+void writeAll(int fd, const char* data, std::size_t size, const std::string& source)
+{
+  while (size > 0) {
+    auto written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      throw InfluxDBException(source, std::strerror(errno));
+    }
+    data += written;
+    size -= written;
+  }
+}
+} // namespace
+
+File::File(const std::string& path, std::size_t rotateSize, std::chrono::seconds rotateInterval,
+  bool compress, std::size_t bufferSize, std::chrono::milliseconds flushInterval) :
+  mPath(path), mRotateSize(rotateSize), mRotateInterval(rotateInterval), mCompress(compress),
+  mBufferSize(bufferSize), mFlushInterval(flushInterval), mFd(-1), mSegmentSize(0), mSequence(0),
+  mStopping(false)
+{
+#ifndef INFLUXDB_WITH_ZLIB
+  if (mCompress) {
+    throw InfluxDBException("File::File", "Compression requires zlib");
+  }
+#endif
+  mBuffer.reserve(mBufferSize);
+  open();
+  if (mCompress || mFlushInterval.count() > 0 || mRotateInterval.count() > 0) {
+    mMaintainer = std::thread(&File::maintain, this);
+  }
+}
+
+File::~File()
+{
+  if (mMaintainer.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopping = true;
+    }
+    mCondition.notify_one();
+    mMaintainer.join();
+  }
+  try {
+    flush();
+  } catch (...) {}
+  ::close(mFd);
+}
+
+void File::open()
+{
+  mFd = ::open(mPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (mFd < 0) {
+    throw InfluxDBException("File::open", mPath + ": " + std::strerror(errno));
+  }
+  struct stat status;
+  mSegmentSize = (::fstat(mFd, &status) == 0) ? status.st_size : 0;
+  mSegmentStart = std::chrono::steady_clock::now();
+}
+
+void File::flush()
+{
+  if (mBuffer.empty()) {
+    return;
+  }
+  writeAll(mFd, mBuffer.data(), mBuffer.size(), "File::flush");
+  mBuffer.clear();
+}
+
+bool File::rotationDue() const
+{
+  return mRotateInterval.count() > 0 && mSegmentSize > 0
+    && std::chrono::steady_clock::now() - mSegmentStart >= mRotateInterval;
+}
+
+void File::send(std::string&& message)
+{
+  std::lock_guard<std::mutex> lock(mWriteMutex);
+  if (rotationDue()) {
+    rotate();
+  }
+  bool terminate = message.empty() || message.back() != '\n';
+  std::size_t size = message.size() + (terminate ? 1 : 0);
+  if (mBuffer.size() + size > mBufferSize) {
+    flush();
+  }
+  if (size > mBufferSize) {
+    if (terminate) message += '\n';
+    writeAll(mFd, message.data(), message.size(), "File::send");
+  } else {
+    mBuffer += message;
+    if (terminate) mBuffer += '\n';
+  }
+  mSegmentSize += size;
+  if (mRotateSize > 0 && mSegmentSize >= mRotateSize) {
+    rotate();
+  }
+}
+
+void File::rotate()
+{
+  flush();
+  ::close(mFd);
+  mFd = -1;
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  std::string rotated = mPath + "." + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(now).count())
+    + "." + std::to_string(mSequence++);
+  if (std::rename(mPath.c_str(), rotated.c_str()) != 0) {
+    throw InfluxDBException("File::rotate", rotated + ": " + std::strerror(errno));
+  }
+  open();
+  if (mCompress) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mPending.push_back(std::move(rotated));
+    mCondition.notify_one();
+  }
+}
+
+void File::maintain()
+{
+  // rotation age is checked at the flush period, or at the rotation interval when not flushing periodically
+  std::chrono::milliseconds tick = mFlushInterval;
+  if (tick.count() == 0 || (mRotateInterval.count() > 0 && mRotateInterval < tick)) {
+    tick = mRotateInterval;
+  }
+  auto ready = [this] { return mStopping || !mPending.empty(); };
+  std::unique_lock<std::mutex> lock(mMutex);
+  for (;;) {
+    if (tick.count() > 0) {
+      mCondition.wait_for(lock, tick, ready);
+    } else {
+      mCondition.wait(lock, ready);
+    }
+    if (!mPending.empty()) {
+      auto segment = std::move(mPending.front());
+      mPending.pop_front();
+      lock.unlock();
+      // segment failing to compress stays plain, Replay reads both
+      Compress(segment, mBufferSize);
+      lock.lock();
+      continue;
+    }
+    if (mStopping) {
+      return;
+    }
+    // rotate() queues segments, so the write lock is never taken while holding mMutex
+    lock.unlock();
+    {
+      std::lock_guard<std::mutex> writeLock(mWriteMutex);
+      try {
+        if (rotationDue()) {
+          rotate();
+        } else if (mFlushInterval.count() > 0) {
+          flush();
+        }
+      } catch (const InfluxDBException&) {
+        // retried on the next tick, send() reports lasting failures
+      }
+    }
+    lock.lock();
+  }
+}
+
+bool File::Compress(const std::string& path, std::size_t chunkSize)
+{
+#ifdef INFLUXDB_WITH_ZLIB
+  auto compressed = path + ".gz";
+  int input = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (input < 0) {
+    return false;
+  }
+  gzFile output = gzopen(compressed.c_str(), "wb6");
+  if (output == nullptr) {
+    ::close(input);
+    return false;
+  }
+  std::string chunk(chunkSize > 0 ? chunkSize : 65536, '\0');
+  bool success = true;
+  for (;;) {
+    auto length = ::read(input, chunk.data(), chunk.size());
+    if (length < 0 && errno == EINTR) continue;
+    if (length <= 0) {
+      success = length == 0;
+      break;
+    }
+    if (gzwrite(output, chunk.data(), static_cast<unsigned>(length)) != length) {
+      success = false;
+      break;
+    }
+  }
+  ::close(input);
+  // closing writes the remaining compressed data
+  if (gzclose(output) != Z_OK) {
+    success = false;
+  }
+  if (!success) {
+    ::unlink(compressed.c_str());
+    return false;
+  }
+  ::unlink(path.c_str());
+  return true;
+#else
+  (void)path;
+  (void)chunkSize;
+  return false;
+#endif
+}
+
+void File::Replay(const std::string& path, const std::function<void(std::string&&)>& sink, std::size_t chunkSize)
+{
+#ifdef INFLUXDB_WITH_ZLIB
+  // gzread reads uncompressed files transparently
+  std::unique_ptr<gzFile_s, decltype(&gzclose)> input(gzopen(path.c_str(), "rb"), &gzclose);
+  if (!input) {
+    throw InfluxDBException("File::Replay", path + ": " + std::strerror(errno));
+  }
+  gzbuffer(input.get(), 256 * 1024);
+  auto readChunk = [&input](char* data, std::size_t size) -> long {
+    return gzread(input.get(), data, size);
+  };
+#else
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw InfluxDBException("File::Replay", path + ": " + std::strerror(errno));
+  }
+  std::unique_ptr<int, void(*)(int*)> input(&fd, [](int* descriptor) { ::close(*descriptor); });
+  auto readChunk = [fd](char* data, std::size_t size) -> long {
+    return ::read(fd, data, size);
+  };
+#endif
+
+  std::string pending;
+  long length;
+  for (;;) {
+    auto offset = pending.size();
+    auto size = offset < chunkSize ? chunkSize - offset : chunkSize;
+    pending.resize(offset + size);
+    length = readChunk(pending.data() + offset, size);
+    pending.resize(offset + (length > 0 ? length : 0));
+    if (length <= 0) break;
+
+    if (pending.size() < chunkSize) continue;
+    auto lastLine = pending.rfind('\n');
+    if (lastLine == std::string::npos) continue;
+    std::string remainder = pending.substr(lastLine + 1);
+    pending.resize(lastLine + 1);
+    sink(std::move(pending));
+    pending = std::move(remainder);
+  }
+  if (length < 0) {
+    throw InfluxDBException("File::Replay", "Cannot read " + path);
+  }
+  if (!pending.empty()) {
+    sink(std::move(pending));
+  }
+}
+
+} // namespace transports
+} // namespace influxdb
@@ -0,0 +1,131 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_FILE_H
+#define INFLUXDATA_TRANSPORTS_FILE_H
+
+#include "Transport.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief File sink transport, appends line protocol to a local file
+/// Data is written in large chunks; the active segment is rotated by size and/or age
+/// and closed segments are optionally gzip compressed. A background thread writes the buffer out
+/// and rotates aged segments even when no data arrives.
+class File : public Transport
+{
+  public:
+    /// Constructor
+    /// \param path             active segment path; rotated segments are named <path>.<epoch>.<sequence>[.gz]
+    /// \param rotateSize       maximum segment size in bytes (0 - no size based rotation)
+    /// \param rotateInterval   maximum segment age (0 - no time based rotation)
+    /// \param compress         gzip rotated segments
+    /// \param bufferSize       size of user space write buffer
+    /// \param flushInterval    maximum time data stays in the buffer (0 - only when full)
+    /// \throw InfluxDBException	if file cannot be opened or compression is not available
+    File(const std::string& path, std::size_t rotateSize = 0,
+      std::chrono::seconds rotateInterval = std::chrono::seconds(0),
+      bool compress = false, std::size_t bufferSize = 1024 * 1024,
+      std::chrono::milliseconds flushInterval = std::chrono::seconds(1));
+
+    /// Flushes buffer, closes file and waits for compression of rotated segments
+    ~File();
+
+    /// Appends newline terminated message to the buffer (thread-safe)
+    /// \throw InfluxDBException	when write fails
+    void send(std::string&& message) override;
+
+    /// Reads a segment (plain or gzip compressed) and passes it to sink in chunks
+    /// of at most chunkSize bytes (longer lines are passed as they are), always split on line boundary
+    /// \throw InfluxDBException	if file cannot be read
+    static void Replay(const std::string& path, const std::function<void(std::string&&)>& sink,
+      std::size_t chunkSize = 1024 * 1024);
+
+    /// Compresses a segment into <path>.gz and removes it; on failure the segment is kept as it is
+    /// \return false if compression failed or is not available
+    static bool Compress(const std::string& path, std::size_t chunkSize = 1024 * 1024);
+
+  private:
+    /// Writes buffer to file; write lock held
+    void flush();
+
+    /// Opens active segment
+    void open();
+
+    /// Closes active segment, renames it and queues it for compression when requested; write lock held
+    void rotate();
+
+    /// \return whether active segment reached rotation age; write lock held
+    bool rotationDue() const;
+
+    /// Compresses queued segments, flushes buffer and rotates aged segment periodically until stopped
+    void maintain();
+
+    /// Active segment path
+    std::string mPath;
+
+    /// Rotation size
+    std::size_t mRotateSize;
+
+    /// Rotation interval
+    std::chrono::seconds mRotateInterval;
+
+    /// Whether rotated segments are compressed
+    bool mCompress;
+
+    /// Write buffer capacity
+    std::size_t mBufferSize;
+
+    /// Write buffer
+    std::string mBuffer;
+
+    /// Buffer flush period
+    std::chrono::milliseconds mFlushInterval;
+
+    /// File descriptor of active segment
+    int mFd;
+
+    /// Bytes in active segment (including buffer)
+    std::size_t mSegmentSize;
+
+    /// Active segment opening time
+    std::chrono::steady_clock::time_point mSegmentStart;
+
+    /// Rotated segments counter
+    unsigned int mSequence;
+
+    /// Guards buffer and active segment
+    std::mutex mWriteMutex;
+
+    /// Rotated segments waiting for compression
+    std::deque<std::string> mPending;
+
+    /// Guards pending segments
+    std::mutex mMutex;
+
+    /// Signals queued segment or stop
+    std::condition_variable mCondition;
+
+    /// Whether background thread shall exit once pending segments are done
+    bool mStopping;
+
+    /// Background compressor and flusher
+    std::thread mMaintainer;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_FILE_H
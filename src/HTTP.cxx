@@ -3,7 +3,9 @@
 ///
 
 #include "HTTP.h"
+#include "CurlShare.h"
 #include "InfluxDBException.h"
+#include <algorithm>
 #include <iostream>
 
 namespace influxdb
@@ -11,39 +13,95 @@ namespace influxdb
 namespace transports
 {
 
-HTTP::HTTP(const std::string& url)
+HTTP::HTTP(const std::string& url) :
+  mAuthHeader(nullptr), mReadHeader(nullptr), mMsgPack(false), mPrecision(Precision::Nanoseconds)
 {
+  parseUrl(url);
   initCurl(url);
   initCurlRead(url);
 }
 
-void HTTP::initCurl(const std::string& url)
+void HTTP::parseUrl(const std::string& url)
 {
-  CURLcode globalInitResult = curl_global_init(CURL_GLOBAL_ALL);
-  if (globalInitResult != CURLE_OK) {
-    throw InfluxDBException("HTTP::initCurl", curl_easy_strerror(globalInitResult));
-  }
-
-  std::string writeUrl = url;
-  auto position = writeUrl.find("?");
+  auto position = url.find("?");
   if (position == std::string::npos) {
      throw InfluxDBException("HTTP::initCurl", "Database not specified");
   }
-  if (writeUrl.at(position - 1) != '/') {
-    writeUrl.insert(position, "/write");
-  } else {
-    writeUrl.insert(position, "write");
+  mBaseUrl = url.substr(0, position);
+  if (!mBaseUrl.empty() && mBaseUrl.back() == '/') {
+    mBaseUrl.pop_back();
+  }
+
+  std::string bucket;
+  std::string search = url.substr(position + 1);
+  while (!search.empty()) {
+    auto end = search.find('&');
+    std::string parameter = search.substr(0, end);
+    search = (end == std::string::npos) ? "" : search.substr(end + 1);
+    std::string name = parameter.substr(0, parameter.find('='));
+    if (name == "token" || name == "precision" || name == "epoch" || name == "format") {
+      // consumed by InfluxDBFactory or derived from precision, never sent to server as given
+      continue;
+    }
+    if (name == "bucket") {
+      bucket = parameter.substr(name.size() + 1);
+    }
+    auto& parameters = (name == "org" || name == "bucket") ? mWriteParameters : mParameters;
+    if (!parameters.empty()) parameters += "&";
+    parameters += parameter;
+  }
+
+  mVersion2 = !bucket.empty();
+  if (mVersion2) {
+    mReadParameters = "db=" + bucket;
+  } else if (mParameters.find("db=") != 0 && mParameters.find("&db=") == std::string::npos) {
+    throw InfluxDBException("HTTP::initCurl", "Database not specified");
+  }
+}
+
+std::string HTTP::writeUrl() const
+{
+  static const char* version1[] = {"s", "ms", "u", "n"};
+  static const char* version2[] = {"s", "ms", "us", "ns"};
+  auto precision = static_cast<int>(mPrecision);
+  std::string url = mBaseUrl + (mVersion2 ? "/api/v2/write?" : "/write?") + mParameters;
+  if (!mWriteParameters.empty()) {
+    url += (mParameters.empty() ? "" : "&") + mWriteParameters;
+  }
+  if (mPrecision != Precision::Nanoseconds) {
+    url += std::string("&precision=") + (mVersion2 ? version2[precision] : version1[precision]);
+  }
+  return url;
+}
+
+void HTTP::updateReadUrl()
+{
+  // timestamps are requested as integers, much cheaper to parse than RFC3339
+  static const char* epoch[] = {"s", "ms", "u", "ns"};
+  mReadUrl = mBaseUrl + "/query?" + mParameters;
+  if (!mReadParameters.empty()) {
+    mReadUrl += (mParameters.empty() ? "" : "&") + mReadParameters;
   }
-  writeHandle = curl_easy_init();
-  curl_easy_setopt(writeHandle, CURLOPT_URL,  writeUrl.c_str());
+  mReadUrl += std::string("&epoch=") + epoch[static_cast<int>(mPrecision)] + "&q=";
+}
+
+/// Discards response body of writes
+static size_t DiscardCallback(void* /*contents*/, size_t size, size_t nmemb, void* /*userp*/)
+{
+  return size * nmemb;
+}
+
+void HTTP::initCurl(const std::string& /*url*/)
+{
+  writeHandle = CurlShare::Instance().createHandle();
+  curl_easy_setopt(writeHandle, CURLOPT_URL,  writeUrl().c_str());
   curl_easy_setopt(writeHandle, CURLOPT_SSL_VERIFYPEER, 0);
   curl_easy_setopt(writeHandle, CURLOPT_CONNECTTIMEOUT, 10);
   curl_easy_setopt(writeHandle, CURLOPT_TIMEOUT, 10);
   curl_easy_setopt(writeHandle, CURLOPT_POST, 1);
   curl_easy_setopt(writeHandle, CURLOPT_TCP_KEEPIDLE, 120L);
   curl_easy_setopt(writeHandle, CURLOPT_TCP_KEEPINTVL, 60L);
-  FILE *devnull = fopen("/dev/null", "w+");
-  curl_easy_setopt(writeHandle, CURLOPT_WRITEDATA, devnull);
+  curl_easy_setopt(writeHandle, CURLOPT_WRITEFUNCTION, DiscardCallback);
 }
 
 static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
@@ -52,61 +110,345 @@ static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *use
     return size * nmemb;
 }
 
-void HTTP::initCurlRead(const std::string& url)
+/// Connections opened to the server by asynchronous queries, further queries wait in curl queue
+static constexpr long MaxQueryConnections = 16;
+
+struct HTTP::Request
+{
+  CURL* handle;
+  std::string url;
+  std::string body;
+  std::string response;
+  QueryHandler handler;
+  ChunkHandler chunks;
+  bool write = false;
+};
+
+size_t HTTP::ChunkCallback(void* contents, size_t size, size_t nmemb, void* userp)
 {
-  mReadUrl = url + "&q=";
-  mReadUrl.insert(mReadUrl.find("?"), "/query");
-  readHandle = curl_easy_init();
-  curl_easy_setopt(readHandle, CURLOPT_SSL_VERIFYPEER, 0); 
-  curl_easy_setopt(readHandle, CURLOPT_CONNECTTIMEOUT, 10);
-  curl_easy_setopt(readHandle, CURLOPT_TIMEOUT, 10);
-  curl_easy_setopt(readHandle, CURLOPT_TCP_KEEPIDLE, 120L);
-  curl_easy_setopt(readHandle, CURLOPT_TCP_KEEPINTVL, 60L);
-  curl_easy_setopt(readHandle, CURLOPT_WRITEFUNCTION, WriteCallback);
+  auto request = static_cast<Request*>(userp);
+  request->response.append(static_cast<char*>(contents), size * nmemb);
+  std::size_t begin = 0;
+  try {
+    for (auto end = request->response.find('\n'); end != std::string::npos;
+      end = request->response.find('\n', begin)) {
+      if (end > begin) {
+        request->chunks(request->response.substr(begin, end - begin), false, nullptr);
+      }
+      begin = end + 1;
+    }
+  } catch (...) {
+    // aborts the transfer, the handler receives the error as the last chunk
+    return 0;
+  }
+  request->response.erase(0, begin);
+  return size * nmemb;
 }
 
-std::string HTTP::query(const std::string& query)
+void HTTP::initCurlRead(const std::string& /*url*/)
+{
+  updateReadUrl();
+  mMulti = curl_multi_init();
+  curl_multi_setopt(mMulti, CURLMOPT_MAX_HOST_CONNECTIONS, MaxQueryConnections);
+  mStop = false;
+}
+
+CURL* HTTP::acquireReadHandle()
+{
+  std::lock_guard<std::mutex> lock(mReadMutex);
+  CURL* handle;
+  if (mReadHandles.empty()) {
+    handle = CurlShare::Instance().createHandle();
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, 10);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT, 10);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, 120L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, 60L);
+  } else {
+    handle = mReadHandles.back();
+    mReadHandles.pop_back();
+  }
+  curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+  curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+  if (!mBasicAuth.empty()) {
+    curl_easy_setopt(handle, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
+    curl_easy_setopt(handle, CURLOPT_USERPWD, mBasicAuth.c_str());
+  }
+  curl_easy_setopt(handle, CURLOPT_HTTPHEADER, mReadHeader);
+  return handle;
+}
+
+void HTTP::releaseReadHandle(CURL* handle)
+{
+  std::lock_guard<std::mutex> lock(mReadMutex);
+  mReadHandles.push_back(handle);
+}
+
+std::string HTTP::queryUrl(CURL* handle, const std::string& query)
+{
+  char* encodedQuery = curl_easy_escape(handle, query.c_str(), query.size());
+  std::string url;
+  {
+    std::lock_guard<std::mutex> lock(mReadMutex);
+    url = mReadUrl;
+  }
+  url += encodedQuery;
+  curl_free(encodedQuery);
+  return url;
+}
+
+void HTTP::checkWriteResponse(CURLcode response, long responseCode)
+{
+  if (response != CURLE_OK) {
+    throw InfluxDBException("HTTP::write", curl_easy_strerror(response));
+  }
+  if (responseCode < 200 || responseCode > 206) {
+    throw InfluxDBException("HTTP::write", "Response code: " + std::to_string(responseCode));
+  }
+}
+
+void HTTP::checkQueryResponse(CURLcode response, long responseCode)
 {
-  CURLcode response;
-  long responseCode;
-  std::string buffer;
-  char* encodedQuery = curl_easy_escape(readHandle, query.c_str(), query.size());
-  auto fullUrl = mReadUrl + std::string(encodedQuery);
-  curl_easy_setopt(readHandle, CURLOPT_URL, fullUrl.c_str());
-  curl_easy_setopt(readHandle, CURLOPT_WRITEDATA, &buffer);
-  response = curl_easy_perform(readHandle);
-  curl_easy_getinfo(readHandle, CURLINFO_RESPONSE_CODE, &responseCode);
   if (response != CURLE_OK) {
     throw InfluxDBException("HTTP::query", curl_easy_strerror(response));
   }
   if (responseCode !=  200) {
     throw InfluxDBException("HTTP::query", "Status code: " + std::to_string(responseCode));
   }
+}
+
+std::string HTTP::query(const std::string& query)
+{
+  long responseCode = 0;
+  std::string buffer;
+  CURL* handle = acquireReadHandle();
+  auto fullUrl = queryUrl(handle, query);
+  curl_easy_setopt(handle, CURLOPT_URL, fullUrl.c_str());
+  curl_easy_setopt(handle, CURLOPT_WRITEDATA, &buffer);
+  CURLcode response = curl_easy_perform(handle);
+  curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &responseCode);
+  releaseReadHandle(handle);
+  checkQueryResponse(response, responseCode);
   return buffer;
 }
 
+void HTTP::queryAsync(const std::string& query, QueryHandler handler)
+{
+  auto request = std::make_unique<Request>();
+  request->handle = acquireReadHandle();
+  request->url = queryUrl(request->handle, query);
+  request->handler = std::move(handler);
+  curl_easy_setopt(request->handle, CURLOPT_URL, request->url.c_str());
+  curl_easy_setopt(request->handle, CURLOPT_WRITEDATA, &request->response);
+  submit(std::move(request));
+}
+
+void HTTP::queryChunked(const std::string& query, std::size_t chunkSize, ChunkHandler handler)
+{
+  auto request = std::make_unique<Request>();
+  request->handle = acquireReadHandle();
+  request->url = queryUrl(request->handle, query) + "&chunked=true&chunk_size=" + std::to_string(chunkSize);
+  request->chunks = std::move(handler);
+  request->handler = [chunks = request->chunks](std::string&& rest, std::exception_ptr error) {
+    chunks(std::move(rest), true, error);
+  };
+  {
+    // chunks are newline delimited only in JSON
+    std::lock_guard<std::mutex> lock(mReadMutex);
+    curl_easy_setopt(request->handle, CURLOPT_HTTPHEADER, mAuthHeader);
+  }
+  curl_easy_setopt(request->handle, CURLOPT_URL, request->url.c_str());
+  curl_easy_setopt(request->handle, CURLOPT_WRITEFUNCTION, ChunkCallback);
+  curl_easy_setopt(request->handle, CURLOPT_WRITEDATA, request.get());
+  submit(std::move(request));
+}
+
+void HTTP::sendAsync(std::string&& post, SendHandler handler)
+{
+  auto request = std::make_unique<Request>();
+  request->handle = acquireReadHandle();
+  request->url = writeUrl();
+  request->body = std::move(post);
+  request->handler = [handler = std::move(handler)](std::string&&, std::exception_ptr error) {
+    handler(error);
+  };
+  request->write = true;
+  curl_easy_setopt(request->handle, CURLOPT_URL, request->url.c_str());
+  curl_easy_setopt(request->handle, CURLOPT_POSTFIELDS, request->body.c_str());
+  curl_easy_setopt(request->handle, CURLOPT_POSTFIELDSIZE, (long) request->body.size());
+  curl_easy_setopt(request->handle, CURLOPT_WRITEDATA, &request->response);
+  submit(std::move(request));
+}
+
+void HTTP::submit(std::unique_ptr<Request> request)
+{
+  std::lock_guard<std::mutex> lock(mReadMutex);
+  mSubmitted.push_back(std::move(request));
+  if (!mQueryThread.joinable()) {
+    mQueryThread = std::thread(&HTTP::processQueries, this);
+  }
+  mQueryCondition.notify_one();
+#if LIBCURL_VERSION_NUM >= 0x074400
+  curl_multi_wakeup(mMulti);
+#endif
+}
+
+void HTTP::processQueries()
+{
+  std::vector<std::unique_ptr<Request>> active;
+  auto complete = [this](std::unique_ptr<Request> request, std::exception_ptr error) {
+    curl_multi_remove_handle(mMulti, request->handle);
+    releaseReadHandle(request->handle);
+    try {
+      request->handler(std::move(request->response), error);
+    } catch (...) {
+      // handler failure must not stop other queries
+    }
+  };
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mReadMutex);
+      mQueryCondition.wait(lock, [&] { return mStop || !active.empty() || !mSubmitted.empty(); });
+      if (mStop) {
+        break;
+      }
+      for (auto& request : mSubmitted) {
+        curl_multi_add_handle(mMulti, request->handle);
+        active.push_back(std::move(request));
+      }
+      mSubmitted.clear();
+    }
+
+    int running;
+    curl_multi_perform(mMulti, &running);
+    int left;
+    while (CURLMsg* message = curl_multi_info_read(mMulti, &left)) {
+      if (message->msg != CURLMSG_DONE) {
+        continue;
+      }
+      auto found = std::find_if(active.begin(), active.end(), [&](const auto& request) {
+        return request->handle == message->easy_handle;
+      });
+      auto request = std::move(*found);
+      active.erase(found);
+      long responseCode = 0;
+      curl_easy_getinfo(request->handle, CURLINFO_RESPONSE_CODE, &responseCode);
+      std::exception_ptr error;
+      try {
+        if (request->write) {
+          checkWriteResponse(message->data.result, responseCode);
+        } else {
+          checkQueryResponse(message->data.result, responseCode);
+        }
+      } catch (...) {
+        error = std::current_exception();
+      }
+      complete(std::move(request), error);
+    }
+
+    if (!active.empty()) {
+#if LIBCURL_VERSION_NUM >= 0x074400
+      curl_multi_poll(mMulti, nullptr, 0, 1000, nullptr);
+#else
+      curl_multi_wait(mMulti, nullptr, 0, 10, nullptr);
+#endif
+    }
+  }
+
+  // transport destroyed: fail outstanding queries
+  auto error = std::make_exception_ptr(InfluxDBException("HTTP::processQueries", "Transport destroyed"));
+  for (auto& request : active) {
+    complete(std::move(request), error);
+  }
+  for (auto& request : mSubmitted) {
+    complete(std::move(request), error);
+  }
+}
+
 void HTTP::enableBasicAuth(const std::string& auth)
 {
   curl_easy_setopt(writeHandle, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
   curl_easy_setopt(writeHandle, CURLOPT_USERPWD, auth.c_str());
-  curl_easy_setopt(readHandle, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
-  curl_easy_setopt(readHandle, CURLOPT_USERPWD, auth.c_str());
+  std::lock_guard<std::mutex> lock(mReadMutex);
+  mBasicAuth = auth;
+}
+
+void HTTP::enableTokenAuth(const std::string& token)
+{
+  std::lock_guard<std::mutex> lock(mReadMutex);
+  curl_slist_free_all(mAuthHeader);
+  mAuthHeader = curl_slist_append(nullptr, ("Authorization: Token " + token).c_str());
+  curl_easy_setopt(writeHandle, CURLOPT_HTTPHEADER, mAuthHeader);
+  updateReadHeader();
+}
+
+void HTTP::acceptMsgPack()
+{
+  std::lock_guard<std::mutex> lock(mReadMutex);
+  mMsgPack = true;
+  updateReadHeader();
+}
+
+void HTTP::updateReadHeader()
+{
+  curl_slist_free_all(mReadHeader);
+  mReadHeader = nullptr;
+  for (auto header = mAuthHeader; header != nullptr; header = header->next) {
+    mReadHeader = curl_slist_append(mReadHeader, header->data);
+  }
+  if (mMsgPack) {
+    mReadHeader = curl_slist_append(mReadHeader, "Accept: application/x-msgpack");
+  }
+}
+
+void HTTP::setPrecision(Precision precision)
+{
+  mPrecision = precision;
+  curl_easy_setopt(writeHandle, CURLOPT_URL, writeUrl().c_str());
+  std::lock_guard<std::mutex> lock(mReadMutex);
+  updateReadUrl();
 }
 
 void HTTP::enableSsl()
 {
-  curl_easy_setopt(readHandle, CURLOPT_SSL_VERIFYPEER, 0L);
+  // read handles never verify peer
   curl_easy_setopt(writeHandle, CURLOPT_SSL_VERIFYPEER, 0L);
 }
 
 HTTP::~HTTP()
 {
+  {
+    std::lock_guard<std::mutex> lock(mReadMutex);
+    mStop = true;
+    mQueryCondition.notify_one();
+#if LIBCURL_VERSION_NUM >= 0x074400
+    curl_multi_wakeup(mMulti);
+#endif
+  }
+  if (mQueryThread.joinable()) {
+    mQueryThread.join();
+  }
   curl_easy_cleanup(writeHandle);
-  curl_easy_cleanup(readHandle);
-  curl_global_cleanup();
+  for (auto handle : mReadHandles) {
+    curl_easy_cleanup(handle);
+  }
+  curl_multi_cleanup(mMulti);
+  curl_slist_free_all(mAuthHeader);
+  curl_slist_free_all(mReadHeader);
 }
 
 void HTTP::send(std::string&& post)
+{
+  write(post);
+}
+
+void HTTP::sendShared(const std::shared_ptr<const std::string>& post)
+{
+  write(*post);
+}
+
+void HTTP::write(const std::string& post)
 {
   CURLcode response;
   long responseCode;
@@ -114,12 +456,7 @@ void HTTP::send(std::string&& post)
   curl_easy_setopt(writeHandle, CURLOPT_POSTFIELDSIZE, (long) post.length());
   response = curl_easy_perform(writeHandle);
   curl_easy_getinfo(writeHandle, CURLINFO_RESPONSE_CODE, &responseCode);
-  if (response != CURLE_OK) {
-    throw InfluxDBException("HTTP::send", curl_easy_strerror(response));
-  }
-  if (responseCode < 200 || responseCode > 206) {
-    throw InfluxDBException("HTTP::send", "Response code: " + std::to_string(responseCode));
-  }
+  checkWriteResponse(response, responseCode);
 }
 
 } // namespace transports
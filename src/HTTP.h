@@ -7,8 +7,13 @@
 
 #include "Transport.h"
 #include <curl/curl.h>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace influxdb
 {
@@ -29,17 +34,58 @@ class HTTP : public Transport
     ///  \throw InfluxDBException	when CURL fails on POSTing or response code != 200
     void send(std::string&& post) override;
 
-    /// Queries database
+    /// Sends shared point batch via HTTP POST without copying it
+    ///  \throw InfluxDBException	when CURL fails on POSTing or response code != 200
+    void sendShared(const std::shared_ptr<const std::string>& post) override;
+
+    /// Sends point batch in background over the curl multi handle used by asynchronous queries,
+    /// the handler is called from the transport thread
+    void sendAsync(std::string&& post, SendHandler handler) override;
+
+    /// Queries database (thread-safe, concurrent calls use separate connections)
     /// \throw InfluxDBException	when CURL GET fails
     std::string query(const std::string& query) override;
 
+    /// Queries database in background; queries run concurrently over a curl multi handle
+    /// and the handler is called from the transport thread
+    void queryAsync(const std::string& query, QueryHandler handler) override;
+
+    /// Queries database in background with chunked=true; each newline delimited JSON response of the stream
+    /// is passed to the handler from the transport thread as soon as it is received (MessagePack is not used)
+    void queryChunked(const std::string& query, std::size_t chunkSize, ChunkHandler handler) override;
+
     /// Enable Basic Auth
     /// \param auth <username>:<password>
     void enableBasicAuth(const std::string& auth);
 
+    /// Enable token authentication (InfluxDB 2.x)
+    /// \param token   API token
+    void enableTokenAuth(const std::string& token);
+
+    /// Sets timestamp precision passed to write endpoint and requested for query results
+    void setPrecision(Precision precision) override;
+
+    /// Requests query responses in MessagePack instead of JSON (InfluxDB 1.4+)
+    void acceptMsgPack();
+
     /// Enable SSL
     void enableSsl();
   private:
+    /// Query or write waiting for or being transferred by the multi handle
+    struct Request;
+
+    /// Splits URL into base and parameters and detects API version (2.x if bucket= present)
+    /// \throw InfluxDBException	if neither database (?db=) nor bucket (?bucket=) specified
+    void parseUrl(const std::string& url);
+
+    /// \return write endpoint URL including precision
+    std::string writeUrl() const;
+
+    /// Builds query endpoint URL requesting integer timestamps in selected precision
+    void updateReadUrl();
+
+    /// POSTs data to write endpoint
+    void write(const std::string& post);
 
     /// Initilizes CURL for writting and common options
     /// \throw InfluxDBException	if database (?db=) not specified
@@ -48,14 +94,92 @@ class HTTP : public Transport
     /// Initializes CURL for reading
     void initCurlRead(const std::string& url);
 
+    /// Takes idle handle from the pool of queries and asynchronous writes (creates new one if none left),
+    /// resets it to GET and applies authentication
+    CURL* acquireReadHandle();
+
+    /// Returns read handle to the pool
+    void releaseReadHandle(CURL* handle);
+
+    /// \return query endpoint URL with escaped query
+    std::string queryUrl(CURL* handle, const std::string& query);
+
+    /// Checks transfer result
+    /// \throw InfluxDBException	when transfer failed or response code != 200
+    static void checkQueryResponse(CURLcode response, long responseCode);
+
+    /// Checks write result
+    /// \throw InfluxDBException	when transfer failed or response code is not 2xx
+    static void checkWriteResponse(CURLcode response, long responseCode);
+
+    /// Queues request for the query thread, starts the thread with the first one
+    void submit(std::unique_ptr<Request> request);
+
+    /// Rebuilds headers sent with queries (authorization, accepted format)
+    void updateReadHeader();
+
+    /// Drives the multi handle and completes asynchronous queries and writes, runs in mQueryThread
+    void processQueries();
+
+    /// Passes each complete line of a chunked response to the request handler, keeps the incomplete tail
+    static size_t ChunkCallback(void* contents, size_t size, size_t nmemb, void* userp);
+
     /// CURL pointer configured for writting points
     CURL* writeHandle;
 
-    /// CURL poiter confgured for querying
-    CURL* readHandle;
+    /// Idle CURL handles configured for querying
+    std::vector<CURL*> mReadHandles;
+
+    /// Multi handle transferring asynchronous queries
+    CURLM* mMulti;
+
+    /// Asynchronous requests not yet added to the multi handle
+    std::deque<std::unique_ptr<Request>> mSubmitted;
+
+    /// Guards read handles, read URL, headers, authentication and submitted queries
+    std::mutex mReadMutex;
+
+    /// Wakes up idle query thread
+    std::condition_variable mQueryCondition;
+
+    /// Thread processing asynchronous requests (started with the first one)
+    std::thread mQueryThread;
+
+    /// Stops query thread
+    bool mStop;
+
+    /// Basic authentication credentials (<username>:<password>)
+    std::string mBasicAuth;
 
     /// InfluxDB read URL
     std::string mReadUrl;
+
+    /// Server URL without path and parameters
+    std::string mBaseUrl;
+
+    /// Parameters passed to both write and query endpoints
+    std::string mParameters;
+
+    /// Parameters passed to write endpoint only
+    std::string mWriteParameters;
+
+    /// Parameters passed to query endpoint only
+    std::string mReadParameters;
+
+    /// Whether InfluxDB 2.x API is used
+    bool mVersion2;
+
+    /// Authorization header
+    struct curl_slist* mAuthHeader;
+
+    /// Headers sent with queries
+    struct curl_slist* mReadHeader;
+
+    /// Whether MessagePack responses are requested
+    bool mMsgPack;
+
+    /// Timestamp precision
+    Precision mPrecision;
 };
 
 } // namespace transports
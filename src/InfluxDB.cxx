@@ -4,45 +4,274 @@
 
 #include "InfluxDB.h"
 #include "InfluxDBException.h"
+#include "File.h"
+#include "TimestampFormatter.h"
+#include "JsonDecoder.h"
+#include "MsgPackDecoder.h"
+#include "ResultBuilder.h"
+#include "QueryCache.h"
+#include "TagKeys.h"
+#include "Compactor.h"
+#include "CardinalityGuard.h"
+#include "BatchTuner.h"
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
 
-#ifdef INFLUXDB_WITH_BOOST
-#include <boost/lexical_cast.hpp>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/json_parser.hpp>
-#endif
 
 namespace influxdb
 {
 
 InfluxDB::InfluxDB(std::unique_ptr<Transport> transport) :
-  mTransport(std::move(transport))
+  mTransport(std::move(transport)), mTagKeys(std::make_shared<TagKeys>())
 {
   mBuffer = {};
   mBuffering = false;
   mBufferSize = 0;
+  mBufferBytes = 0;
+  mCompaction = false;
   mGlobalTags = {};
+  mPrecision = Precision::Nanoseconds;
+  mServerTimestamps = false;
+  mBudget = 0;
+  mBackpressure = Backpressure::Block;
+  mTimeout = std::chrono::seconds(1);
+  mSampleCounter = 0;
+  mStats = {};
+  mLaneMode = false;
+  mStopping = false;
+  mFlushing = 0;
+  mFlushRequested = false;
+  mInFlight = 0;
+  mAsyncWrites = 0;
 }
 
 void InfluxDB::batchOf(const std::size_t size)
 {
+  std::lock_guard<std::mutex> lock(mWriteMutex);
   mBufferSize = size;
   mBuffering = true;
+  mTuner.reset();
+}
+
+void InfluxDB::adaptiveBatching(std::size_t minSize, std::size_t maxSize, std::chrono::milliseconds targetLatency,
+  std::chrono::milliseconds maxInterval)
+{
+  std::lock_guard<std::mutex> lock(mWriteMutex);
+  mTuner = std::make_unique<BatchTuner>(minSize, maxSize, targetLatency, maxInterval);
+  mBufferSize = mTuner->size();
+  mBuffering = true;
+  if (!mLaneMode && !mSender.joinable()) {
+    mSender = std::thread(&InfluxDB::flushPartial, this);
+  }
+}
+
+void InfluxDB::tune(std::size_t points, std::chrono::steady_clock::time_point start, bool failed)
+{
+  auto latency = std::chrono::steady_clock::now() - start;
+  std::lock_guard<std::mutex> lock(mWriteMutex);
+  if (!mTuner) {
+    return;
+  }
+  mTuner->record(points, latency, failed);
+  mBufferSize = mTuner->size();
+}
+
+void InfluxDB::compactBatches(bool enable)
+{
+  mCompaction = enable;
+}
+
+void InfluxDB::priorityLanes(Lane high, Lane normal, Lane low)
+{
+  std::unique_lock<std::mutex> lock(mWriteMutex);
+  std::array<Lane, 3> settings{high, normal, low};
+  for (std::size_t i = 0; i < mLanes.size(); i++) {
+    mLanes[i].settings = settings[i];
+    mLanes[i].settings.batchSize = std::max<std::size_t>(1, settings[i].batchSize);
+  }
+  if (!mLaneMode) {
+    mLaneMode = true;
+    // partial batch flusher of adaptive batching exits
+    if (mSender.joinable()) {
+      mWake.notify_one();
+      lock.unlock();
+      mSender.join();
+      lock.lock();
+    }
+    // points buffered by batchOf() so far go out with normal priority
+    if (!mBuffer.empty()) {
+      auto& lane = mLanes[static_cast<std::size_t>(Priority::Normal)];
+      if (lane.buffer.empty()) {
+        lane.deadline = std::chrono::steady_clock::now() + lane.settings.maxDelay;
+      }
+      std::move(mBuffer.begin(), mBuffer.end(), std::back_inserter(lane.buffer));
+      lane.bytes += mBufferBytes;
+      mBuffer.clear();
+      mBufferBytes = 0;
+    }
+    mSender = std::thread(&InfluxDB::send, this);
+  }
+}
+
+void InfluxDB::memoryBudget(std::size_t bytes, Backpressure policy, std::chrono::milliseconds timeout)
+{
+  std::lock_guard<std::mutex> lock(mWriteMutex);
+  mBudget = bytes;
+  mBackpressure = policy;
+  mTimeout = timeout;
+  mReleased.notify_all();
+}
+
+InfluxDB::Stats InfluxDB::stats() const
+{
+  std::lock_guard<std::mutex> lock(mWriteMutex);
+  auto stats = mStats;
+  stats.limited = mCardinalityGuard ? mCardinalityGuard->limited() : 0;
+  stats.transportDropped = mTransport->dropped();
+  stats.transportFailed = mTransport->failed();
+  stats.batchSize = mBuffering ? mBufferSize : 1;
+  if (mTuner) {
+    stats.flushInterval = mTuner->interval();
+    stats.sendLatency = mTuner->latency();
+    stats.throughput = mTuner->throughput();
+  }
+  return stats;
+}
+
+void InfluxDB::cardinalityLimit(std::size_t series, CardinalityPolicy policy)
+{
+  mCardinalityGuard = std::make_unique<CardinalityGuard>(series, policy);
+}
+
+std::size_t InfluxDB::seriesCardinality(std::string_view measurement) const
+{
+  return mCardinalityGuard ? mCardinalityGuard->estimate(measurement) : 0;
+}
+
+void InfluxDB::setPrecision(Precision precision)
+{
+  mPrecision = precision;
+  mTransport->setPrecision(precision);
+  if (mQueryCache) {
+    mQueryCache->clear();
+  }
+}
+
+void InfluxDB::cacheQueries(std::chrono::milliseconds ttl, bool incremental)
+{
+  mQueryCache = std::make_unique<QueryCache>(ttl, incremental);
+}
+
+void InfluxDB::serverTimestamps(bool enable)
+{
+  mServerTimestamps = enable;
 }
 
 void InfluxDB::flushBuffer() {
+  std::unique_lock<std::mutex> lock(mWriteMutex);
+  if (mLaneMode) {
+    mFlushing++;
+    mWake.notify_one();
+    mReleased.wait(lock, [this] {
+      return mInFlight == 0 && std::all_of(mLanes.begin(), mLanes.end(), [](const LaneQueue& lane) {
+        return lane.buffer.empty() && lane.retry.empty();
+      });
+    });
+    mFlushing--;
+    return;
+  }
   if (!mBuffering || mBuffer.empty()) {
     return;
   }
+  flush(lock);
+}
+
+void InfluxDB::flush(std::unique_lock<std::mutex>& lock)
+{
+  auto batch = std::move(mBuffer);
+  auto size = mBufferBytes;
+  mBuffer.clear();
+  mBufferBytes = 0;
+  lock.unlock();
+  try {
+    transmitBatch(std::move(batch), size);
+  } catch (...) {
+    lock.lock();
+    throw;
+  }
+  lock.lock();
+}
+
+void InfluxDB::flushPartial()
+{
+  std::unique_lock<std::mutex> lock(mWriteMutex);
+  while (!mStopping && !mLaneMode) {
+    if (!mTuner || mBuffer.empty()) {
+      mFlushRequested = false;
+      mWake.wait(lock);
+      continue;
+    }
+    auto due = mBufferStart + mTuner->interval();
+    if (!mFlushRequested && std::chrono::steady_clock::now() < due) {
+      mWake.wait_until(lock, due);
+      continue;
+    }
+    mFlushRequested = false;
+    auto points = mBuffer.size();
+    try {
+      flush(lock);
+    } catch (...) {
+      // no writer to report to
+      mStats.failed += points;
+    }
+  }
+}
+
+std::string InfluxDB::serialize(const std::deque<Point>& batch, std::size_t size)
+{
   std::string stringBuffer{};
-  for (const auto &i : mBuffer) {
-    stringBuffer+= i + "\n";
+  stringBuffer.reserve(size);
+  TimestampFormatter formatter;
+  for (const auto& point : batch) {
+    point.appendLineProtocol(stringBuffer, formatter, mPrecision);
   }
-  mBuffer.clear();
-  transmit(std::move(stringBuffer));
+  if (mCompaction) {
+    auto bytes = stringBuffer.size();
+    auto merged = Compactor::Compact(stringBuffer);
+    std::lock_guard<std::mutex> lock(mWriteMutex);
+    mStats.compacted += merged;
+    mStats.compactedBytes += bytes - stringBuffer.size();
+  }
+  return stringBuffer;
+}
+
+void InfluxDB::transmitBatch(std::deque<Point>&& batch, std::size_t size)
+{
+  std::chrono::steady_clock::time_point start;
+  try {
+    transmit(serialize(batch, size), &start);
+  } catch (...) {
+    if (start != std::chrono::steady_clock::time_point{}) {
+      tune(batch.size(), start, true);
+    }
+    release(size);
+    throw;
+  }
+  tune(batch.size(), start, false);
+  release(size);
+}
+
+void InfluxDB::release(std::size_t size)
+{
+  std::lock_guard<std::mutex> lock(mWriteMutex);
+  mStats.pendingBytes -= size;
+  mReleased.notify_all();
 }
 
 void InfluxDB::addGlobalTag(std::string_view key, std::string_view value)
@@ -55,74 +284,666 @@ void InfluxDB::addGlobalTag(std::string_view key, std::string_view value)
 
 InfluxDB::~InfluxDB()
 {
-  if (mBuffering) {
+  if (mLaneMode || mBuffering) {
     flushBuffer();
   }
+  {
+    // completion of asynchronous writes accesses this instance
+    std::unique_lock<std::mutex> lock(mWriteMutex);
+    mReleased.wait(lock, [this] { return mAsyncWrites == 0; });
+  }
+  if (mSender.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mWriteMutex);
+      mStopping = true;
+    }
+    mWake.notify_one();
+    mSender.join();
+  }
 }
 
-void InfluxDB::transmit(std::string&& point)
+void InfluxDB::send()
 {
+  std::unique_lock<std::mutex> lock(mWriteMutex);
+  for (;;) {
+    auto now = std::chrono::steady_clock::now();
+    auto wakeAt = std::chrono::steady_clock::time_point::max();
+    LaneQueue* selected = nullptr;
+    int total = 0;
+    for (auto& lane : mLanes) {
+      std::chrono::steady_clock::time_point due;
+      if (!lane.retry.empty()) {
+        due = mStopping ? now : lane.retryAt;
+      } else if (!lane.buffer.empty()) {
+        bool full = lane.buffer.size() >= lane.settings.batchSize;
+        due = full || mFlushing > 0 || mStopping ? now : lane.deadline;
+      } else {
+        continue;
+      }
+      if (due > now) {
+        wakeAt = std::min(wakeAt, due);
+        continue;
+      }
+      // smooth weighted round robin among due lanes
+      lane.credit += static_cast<int>(lane.settings.weight);
+      total += static_cast<int>(lane.settings.weight);
+      if (selected == nullptr || lane.credit > selected->credit) {
+        selected = &lane;
+      }
+    }
+    if (selected == nullptr) {
+      if (mStopping) {
+        return;
+      }
+      if (wakeAt == std::chrono::steady_clock::time_point::max()) {
+        mWake.wait(lock);
+      } else {
+        mWake.wait_until(lock, wakeAt);
+      }
+      continue;
+    }
+    auto& lane = *selected;
+    lane.credit -= total;
+
+    std::string lines;
+    std::size_t bytes = 0;
+    std::size_t points = 0;
+    unsigned attempts = 0;
+    unsigned retries = lane.settings.retries;
+    mInFlight++;
+    if (!lane.retry.empty()) {
+      lines = std::move(lane.retry);
+      lane.retry.clear();
+      bytes = std::exchange(lane.retryBytes, 0);
+      points = std::exchange(lane.retryPoints, 0);
+      attempts = std::exchange(lane.attempts, 0);
+      lock.unlock();
+    } else {
+      std::deque<Point> batch;
+      if (lane.buffer.size() <= lane.settings.batchSize) {
+        batch.swap(lane.buffer);
+        bytes = std::exchange(lane.bytes, 0);
+      } else {
+        for (std::size_t i = 0; i < lane.settings.batchSize; i++) {
+          bytes += lane.buffer.front().size();
+          batch.push_back(std::move(lane.buffer.front()));
+          lane.buffer.pop_front();
+        }
+        lane.bytes -= bytes;
+      }
+      points = batch.size();
+      lock.unlock();
+      lines = serialize(batch, bytes);
+    }
+
+    bool retry = attempts < retries;
+    bool failed = false;
+    try {
+      transmit(retry ? std::string(lines) : std::move(lines));
+    } catch (...) {
+      failed = true;
+    }
+
+    lock.lock();
+    mInFlight--;
+    if (failed && retry) {
+      lane.retry = std::move(lines);
+      lane.retryBytes = bytes;
+      lane.retryPoints = points;
+      lane.attempts = attempts + 1;
+      lane.retryAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(100) * lane.attempts;
+      continue;
+    }
+    if (failed) {
+      mStats.failed += points;
+    }
+    mStats.pendingBytes -= bytes;
+    mReleased.notify_all();
+  }
+}
+
+void InfluxDB::transmit(std::string&& point, std::chrono::steady_clock::time_point* start)
+{
+  std::lock_guard<std::mutex> lock(mTransmitMutex);
+  // waiting behind another transmission is not latency of this one
+  if (start != nullptr) {
+    *start = std::chrono::steady_clock::now();
+  }
   mTransport->send(std::move(point));
 }
 
-void InfluxDB::write(Point&& metric)
+bool InfluxDB::sample()
 {
-  if (mBuffering) {
-    mBuffer.emplace_back(metric.toLineProtocol());
+  if (mStats.pendingBytes * 2 < mBudget) {
+    return true;
+  }
+  // keep 1 of 2 points at half of the budget, down to 1 of 16 when full
+  auto shift = 1 + std::min<std::size_t>(3, (mStats.pendingBytes * 2 - mBudget) * 4 / mBudget);
+  return (mSampleCounter++ & ((std::size_t{1} << shift) - 1)) == 0;
+}
+
+bool InfluxDB::shed(Priority priority)
+{
+  for (auto index = mLanes.size(); index-- > static_cast<std::size_t>(priority) + 1;) {
+    auto& lane = mLanes[index];
+    if (!lane.retry.empty()) {
+      lane.retry = std::string();
+      mStats.pendingBytes -= std::exchange(lane.retryBytes, 0);
+      mStats.shed += std::exchange(lane.retryPoints, 0);
+      lane.attempts = 0;
+      return true;
+    }
+    if (!lane.buffer.empty()) {
+      auto size = lane.buffer.front().size();
+      lane.buffer.pop_front();
+      lane.bytes -= size;
+      mStats.pendingBytes -= size;
+      mStats.shed++;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool InfluxDB::reserve(std::unique_lock<std::mutex>& lock, std::size_t size, bool block, bool inlineFlush,
+  Priority priority)
+{
+  // high priority points are never sampled out
+  if (mBudget != 0 && mBackpressure == Backpressure::Sample && priority != Priority::High && !sample()) {
+    mStats.sampledOut++;
+    return false;
+  }
+  auto deadline = std::chrono::steady_clock::now() + mTimeout;
+  while (mBudget != 0 && mStats.pendingBytes + size > mBudget) {
+    // own buffer is released by transmitting it, not by waiting; tryWrite() leaves the transmission to the
+    // partial batch flusher of adaptive batching, if any, instead of doing I/O on the caller's thread
+    if (!mBuffer.empty()) {
+      if (inlineFlush) {
+        flush(lock);
+        continue;
+      }
+      if (mTuner) {
+        mFlushRequested = true;
+        mWake.notify_one();
+      }
+    }
+    if (shed(priority)) {
+      mReleased.notify_all();
+      continue;
+    }
+    if (!block || !mReleased.wait_until(lock, deadline, [&] {
+      return mStats.pendingBytes + size <= mBudget || !mBuffer.empty();
+    })) {
+      mStats.dropped++;
+      return false;
+    }
+  }
+  mStats.pendingBytes += size;
+  mStats.written++;
+  return true;
+}
+
+bool InfluxDB::enqueue(Point&& metric, bool block, bool inlineFlush, Priority priority)
+{
+  if (mServerTimestamps) {
+    metric.removeTimestamp();
+  }
+  auto size = metric.size();
+  std::unique_lock<std::mutex> lock(mWriteMutex);
+  if (!reserve(lock, size, block, inlineFlush, priority)) {
+    return false;
+  }
+  if (mLaneMode) {
+    auto& lane = mLanes[static_cast<std::size_t>(priority)];
+    if (lane.buffer.empty()) {
+      lane.deadline = std::chrono::steady_clock::now() + lane.settings.maxDelay;
+    }
+    lane.buffer.emplace_back(std::move(metric));
+    lane.bytes += size;
+    if (lane.buffer.size() == 1 || lane.buffer.size() == lane.settings.batchSize) {
+      mWake.notify_one();
+    }
+  } else if (mBuffering) {
+    if (mTuner && mBuffer.empty()) {
+      mBufferStart = std::chrono::steady_clock::now();
+      mWake.notify_one();
+    }
+    mBuffer.emplace_back(std::move(metric));
+    mBufferBytes += size;
     if (mBuffer.size() >= mBufferSize) {
-      flushBuffer();
+      flush(lock);
+    }
+  } else {
+    lock.unlock();
+    try {
+      transmit(metric.toLineProtocol(mPrecision));
+    } catch (...) {
+      release(size);
+      throw;
     }
+    release(size);
+  }
+  return true;
+}
+
+void InfluxDB::write(Point&& metric, Priority priority)
+{
+  if (mCardinalityGuard && !mCardinalityGuard->admit(metric)) {
+    return;
+  }
+  bool block = mBackpressure == Backpressure::Block;
+  if (!enqueue(std::move(metric), block, true, priority) && block) {
+    throw InfluxDBException("InfluxDB::write", "Memory budget exhausted");
+  }
+}
+
+bool InfluxDB::tryWrite(Point&& metric, Priority priority)
+{
+  if (mCardinalityGuard && !mCardinalityGuard->admit(metric)) {
+    return false;
+  }
+  return enqueue(std::move(metric), false, false, priority);
+}
+
+void InfluxDB::replay(const std::string& path, std::size_t chunkSize)
+{
+  transports::File::Replay(path, [this](std::string&& chunk) { transmit(std::move(chunk)); }, chunkSize);
+}
+
+namespace
+{
+
+/// Decodes JSON or MessagePack response
+void decode(const std::string& response, ResultBuilder& builder)
+{
+  if (MsgPackDecoder::Detect(response)) {
+    MsgPackDecoder::Decode(response, builder);
   } else {
-    transmit(metric.toLineProtocol());
+    JsonDecoder::Decode(response, builder);
   }
 }
 
-#ifdef INFLUXDB_WITH_BOOST
-std::vector<Point> InfluxDB::query(const std::string&  query)
+/// \return points of all statements
+/// \throw InfluxDBException if a statement failed
+std::vector<Point> flatten(ResultBuilder& builder)
 {
-  auto response = mTransport->query(query);
-  std::stringstream ss;
-  ss << response;
   std::vector<Point> points;
-  boost::property_tree::ptree pt;
-  boost::property_tree::read_json(ss, pt);
-
-  for (auto& result : pt.get_child("results")) {
-    auto isResultEmpty = result.second.find("series");
-    if (isResultEmpty == result.second.not_found()) return {};
-    for (auto& series : result.second.get_child("series")) {
-      auto columns = series.second.get_child("columns");
-
-      for (auto& values : series.second.get_child("values")) {
-        Point point{series.second.get<std::string>("name")};
-        auto iColumns = columns.begin();
-        auto iValues = values.second.begin();
-        for (; iColumns != columns.end() && iValues != values.second.end(); iColumns++, iValues++) {
-          auto value = iValues->second.get_value<std::string>();
-          auto column = iColumns->second.get_value<std::string>();
-          if (!column.compare("time")) {
-            std::tm tm = {};
-            std::stringstream ss;
-            ss << value;
-            ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%SZ");
-            point.setTimestamp(std::chrono::system_clock::from_time_t(std::mktime(&tm)));
-            continue;
+  for (auto& statement : builder.results()) {
+    std::move(statement.begin(), statement.end(), std::back_inserter(points));
+  }
+  return points;
+}
+
+/// Decodes response, string columns are classified with known tag keys
+ResultBuilder build(const std::string& response, Precision precision, const TagKeys& tagKeys)
+{
+  ResultBuilder builder(precision, &tagKeys);
+  decode(response, builder);
+  return builder;
+}
+
+/// Stores tag keys from SHOW TAG KEYS response
+/// \return whether the keys could be stored, when not string columns stay fields
+bool update(TagKeys& tagKeys, const std::set<std::string>& measurements, const std::string& response,
+  Precision precision)
+{
+  try {
+    ResultBuilder builder(precision);
+    decode(response, builder);
+    tagKeys.update(measurements, flatten(builder));
+    return true;
+  } catch (const InfluxDBException&) {
+    return false;
+  }
+}
+
+/// Decodes response, tag keys of measurements not known yet are fetched first with a SHOW TAG KEYS query
+ResultBuilder build(const std::string& response, Precision precision, TagKeys& tagKeys, Transport& transport)
+{
+  auto builder = build(response, precision, tagKeys);
+  if (builder.unresolved().empty()) {
+    return builder;
+  }
+  std::string keys;
+  try {
+    keys = transport.query(TagKeys::Query(builder.unresolved()));
+  } catch (const InfluxDBException&) {
+    return builder;
+  }
+  if (!update(tagKeys, builder.unresolved(), keys, precision)) {
+    return builder;
+  }
+  return build(response, precision, tagKeys);
+}
+
+/// Asynchronous build(), tag keys are queried from the transport thread
+/// \param handler  receives decoded response, or null and the decoding error
+void buildAsync(std::string&& response, Precision precision, const std::shared_ptr<TagKeys>& tagKeys,
+  Transport& transport, std::function<void(ResultBuilder*, std::exception_ptr)> handler)
+{
+  std::shared_ptr<ResultBuilder> builder;
+  try {
+    builder = std::make_shared<ResultBuilder>(build(response, precision, *tagKeys));
+  } catch (...) {
+    handler(nullptr, std::current_exception());
+    return;
+  }
+  if (builder->unresolved().empty()) {
+    handler(builder.get(), nullptr);
+    return;
+  }
+  auto query = TagKeys::Query(builder->unresolved());
+  transport.queryAsync(query, [response = std::move(response), precision, tagKeys, builder, handler = std::move(handler)]
+    (std::string&& keys, std::exception_ptr error) {
+      if (error || !update(*tagKeys, builder->unresolved(), keys, precision)) {
+        handler(builder.get(), nullptr);
+        return;
+      }
+      std::unique_ptr<ResultBuilder> resolved;
+      try {
+        resolved = std::make_unique<ResultBuilder>(build(response, precision, *tagKeys));
+      } catch (...) {
+        handler(nullptr, std::current_exception());
+        return;
+      }
+      handler(resolved.get(), nullptr);
+    });
+}
+
+/// Joins statements into a single query
+std::string join(const std::vector<std::string>& statements)
+{
+  std::string query;
+  for (const auto& statement : statements) {
+    if (!query.empty()) query += ";";
+    query += statement;
+  }
+  return query;
+}
+
+/// Sends query asynchronously, fulfills promise with the converted decoded response
+template<typename T, typename Convert>
+std::future<T> queryFuture(Transport& transport, const std::shared_ptr<TagKeys>& tagKeys, Precision precision,
+  const std::string& query, Convert convert)
+{
+  auto promise = std::make_shared<std::promise<T>>();
+  auto future = promise->get_future();
+  transport.queryAsync(query, [&transport, tagKeys, precision, promise, convert]
+    (std::string&& response, std::exception_ptr error) {
+      if (error) {
+        promise->set_exception(error);
+        return;
+      }
+      buildAsync(std::move(response), precision, tagKeys, transport,
+        [promise, convert](ResultBuilder* builder, std::exception_ptr error) {
+          if (error) {
+            promise->set_exception(error);
+            return;
+          }
+          try {
+            promise->set_value(convert(*builder));
+          } catch (...) {
+            promise->set_exception(std::current_exception());
           }
-          // cast all values to double, if strings add to tags
-          try { point.addField(column, boost::lexical_cast<double>(value)); }
-          catch(...) { point.addTag(column, value); }
+        });
+    });
+  return future;
+}
+
+} // namespace
+
+std::vector<Point> InfluxDB::query(const std::string& query)
+{
+  auto fetch = [this](const std::string& statement) {
+    auto builder = build(mTransport->query(statement), mPrecision, *mTagKeys, *mTransport);
+    return flatten(builder);
+  };
+  if (mQueryCache) {
+    return mQueryCache->get(query, fetch);
+  }
+  return fetch(query);
+}
+
+std::future<std::vector<Point>> InfluxDB::queryAsync(const std::string& query)
+{
+  return queryFuture<std::vector<Point>>(*mTransport, mTagKeys, mPrecision, query, [](ResultBuilder& builder) {
+    return flatten(builder);
+  });
+}
+
+void InfluxDB::queryAsync(const std::string& query,
+  std::function<void(std::vector<Point>&&, std::exception_ptr)> handler)
+{
+  auto precision = mPrecision;
+  auto& transport = *mTransport;
+  mTransport->queryAsync(query, [&transport, tagKeys = mTagKeys, precision, handler = std::move(handler)]
+    (std::string&& response, std::exception_ptr error) {
+      if (error) {
+        handler({}, error);
+        return;
+      }
+      buildAsync(std::move(response), precision, tagKeys, transport,
+        [handler](ResultBuilder* builder, std::exception_ptr error) {
+          std::vector<Point> points;
+          if (!error) {
+            try {
+              points = flatten(*builder);
+            } catch (...) {
+              error = std::current_exception();
+            }
+          }
+          handler(std::move(points), error);
+        });
+    });
+}
+
+namespace
+{
+
+/// Chunks of a streamed query, decoded one after another in order of arrival
+struct Stream
+{
+  /// Received chunk, or the error ending the stream
+  struct Chunk
+  {
+    std::string response;
+    bool last;
+    std::exception_ptr error;
+  };
+
+  Stream(Precision precision, std::shared_ptr<TagKeys> tagKeys, Transport& transport,
+    std::function<void(std::vector<Point>&&, bool, std::exception_ptr)> handler) :
+    precision(precision), tagKeys(std::move(tagKeys)), transport(transport), handler(std::move(handler)) {}
+
+  Precision precision;
+  std::shared_ptr<TagKeys> tagKeys;
+  Transport& transport;
+  std::function<void(std::vector<Point>&&, bool, std::exception_ptr)> handler;
+
+  /// Guards all below
+  std::mutex mutex;
+
+  /// Chunks waiting for decoding
+  std::deque<Chunk> chunks;
+
+  /// Whether a chunk is being decoded (tag keys lookup may complete it asynchronously)
+  bool decoding = false;
+
+  /// Whether the last chunk or an error was handed over
+  bool finished = false;
+};
+
+/// Decodes queued chunks until none is left, or until one waits for tag keys (its completion continues)
+void drain(const std::shared_ptr<Stream>& stream)
+{
+  for (;;) {
+    Stream::Chunk chunk;
+    {
+      std::lock_guard<std::mutex> lock(stream->mutex);
+      if (stream->chunks.empty() || stream->finished) {
+        stream->decoding = false;
+        return;
+      }
+      chunk = std::move(stream->chunks.front());
+      stream->chunks.pop_front();
+      stream->finished = chunk.last || chunk.error;
+    }
+    if (chunk.error || chunk.response.find_first_not_of(" \r\n\t") == std::string::npos) {
+      if (chunk.error || chunk.last) {
+        stream->handler({}, true, chunk.error);
+      }
+      continue;
+    }
+    // completion reports whether it ran before buildAsync() returned, otherwise it continues draining itself
+    struct Step
+    {
+      bool inside = true;
+      bool completed = false;
+    };
+    auto step = std::make_shared<Step>();
+    auto last = chunk.last;
+    buildAsync(std::move(chunk.response), stream->precision, stream->tagKeys, stream->transport,
+      [stream, step, last](ResultBuilder* builder, std::exception_ptr error) {
+        std::vector<Point> points;
+        if (!error) {
+          try {
+            points = flatten(*builder);
+          } catch (...) {
+            error = std::current_exception();
+          }
+        }
+        if (error) {
+          std::lock_guard<std::mutex> lock(stream->mutex);
+          stream->finished = true;
         }
-        points.push_back(std::move(point));
+        stream->handler(std::move(points), last || error, error);
+        {
+          std::lock_guard<std::mutex> lock(stream->mutex);
+          if (step->inside) {
+            step->completed = true;
+            return;
+          }
+        }
+        drain(stream);
+      });
+    std::lock_guard<std::mutex> lock(stream->mutex);
+    step->inside = false;
+    if (!step->completed) {
+      return;
+    }
+  }
+}
+
+} // namespace
+
+void InfluxDB::queryChunked(const std::string& query,
+  std::function<void(std::vector<Point>&&, bool, std::exception_ptr)> handler, std::size_t chunkSize)
+{
+  auto stream = std::make_shared<Stream>(mPrecision, mTagKeys, *mTransport, std::move(handler));
+  mTransport->queryChunked(query, chunkSize, [stream](std::string&& response, bool last, std::exception_ptr error) {
+    {
+      std::lock_guard<std::mutex> lock(stream->mutex);
+      stream->chunks.push_back({std::move(response), last, error});
+      if (stream->decoding) {
+        return;
       }
+      stream->decoding = true;
+    }
+    drain(stream);
+  });
+}
+
+void InfluxDB::writeAsync(std::vector<Point>&& points, std::function<void(std::exception_ptr)> handler)
+{
+  std::string lines;
+  std::size_t bytes = 0;
+  TimestampFormatter formatter;
+  std::unique_lock<std::mutex> lock(mWriteMutex);
+  for (auto& point : points) {
+    if (mCardinalityGuard && !mCardinalityGuard->admit(point)) {
+      continue;
+    }
+    if (mLaneMode) {
+      lock.unlock();
+      enqueue(std::move(point), false, false, Priority::Normal);
+      lock.lock();
+      continue;
+    }
+    if (mServerTimestamps) {
+      point.removeTimestamp();
+    }
+    auto size = point.size();
+    if (!reserve(lock, size, false, false, Priority::Normal)) {
+      continue;
     }
+    bytes += size;
+    point.appendLineProtocol(lines, formatter, mPrecision);
+  }
+  // queued points are transmitted by the sender, nothing else to wait for
+  if (lines.empty()) {
+    lock.unlock();
+    handler(nullptr);
+    return;
+  }
+  mAsyncWrites++;
+  lock.unlock();
+
+  // transports without asynchronous sending complete in sendAsync() by a plain send(), which has to be
+  // serialized with other transmissions; such completion is reported once the transmit lock is released
+  struct Completion
+  {
+    std::thread::id caller;
+    bool inside;
+    bool completed;
+    std::exception_ptr error;
+    std::function<void(std::exception_ptr)> handler;
+  };
+  auto completion = std::make_shared<Completion>(Completion{std::this_thread::get_id(), true, false, nullptr,
+    std::move(handler)});
+  {
+    std::lock_guard<std::mutex> transmitLock(mTransmitMutex);
+    mTransport->sendAsync(std::move(lines), [this, bytes, completion](std::exception_ptr error) {
+      {
+        std::lock_guard<std::mutex> lock(mWriteMutex);
+        mStats.pendingBytes -= bytes;
+        mAsyncWrites--;
+        mReleased.notify_all();
+      }
+      if (std::this_thread::get_id() == completion->caller && completion->inside) {
+        completion->completed = true;
+        completion->error = error;
+        return;
+      }
+      completion->handler(error);
+    });
+    completion->inside = false;
+  }
+  if (completion->completed) {
+    completion->handler(completion->error);
   }
-  return points;
 }
-#else
-std::vector<Point> InfluxDB::query(const std::string& /*query*/)
+
+std::vector<StatementResult> InfluxDB::queryBatch(const std::vector<std::string>& statements)
 {
-  throw InfluxDBException("InfluxDB::query", "Boost is required");
+  if (statements.empty()) {
+    return {};
+  }
+  auto builder = build(mTransport->query(join(statements)), mPrecision, *mTagKeys, *mTransport);
+  return builder.results(statements.size());
+}
+
+std::future<std::vector<StatementResult>> InfluxDB::queryBatchAsync(const std::vector<std::string>& statements)
+{
+  auto count = statements.size();
+  if (count == 0) {
+    std::promise<std::vector<StatementResult>> empty;
+    empty.set_value({});
+    return empty.get_future();
+  }
+  return queryFuture<std::vector<StatementResult>>(*mTransport, mTagKeys, mPrecision, join(statements),
+    [count](ResultBuilder& builder) {
+      return builder.results(count);
+    });
 }
-#endif
 
 } // namespace influxdb
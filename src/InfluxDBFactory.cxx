@@ -9,23 +9,69 @@
 #include <map>
 #include "UriParser.h"
 #include "HTTP.h"
+#include "Null.h"
+#include "Memory.h"
+#include "File.h"
+#include "SharedMemory.h"
+#include "Sharded.h"
+#include "Replicated.h"
 #include "InfluxDBException.h"
 
 #ifdef INFLUXDB_WITH_BOOST
 #include "UDP.h"
 #include "UnixSocket.h"
+#include "TCP.h"
+#include "UnixStream.h"
 #endif
 
 namespace influxdb
 {
 
+/// \return value of URI search parameter or fallback when not present
+std::string getParameter(const http::url& uri, const std::string& name, const std::string& fallback = {}) {
+  std::size_t position = 0;
+  while (position < uri.search.size()) {
+    auto end = uri.search.find('&', position);
+    if (end == std::string::npos) end = uri.search.size();
+    auto separator = uri.search.find('=', position);
+    if (separator < end && uri.search.compare(position, separator - position, name) == 0) {
+      return uri.search.substr(separator + 1, end - separator - 1);
+    }
+    position = end + 1;
+  }
+  return fallback;
+}
+
 #ifdef INFLUXDB_WITH_BOOST
+/// \return shared I/O context when asynchronous sending is requested (async=1), null otherwise
+std::shared_ptr<transports::IoContext> getIoContext(const http::url& uri) {
+  if (getParameter(uri, "async", "0") == "0") {
+    return nullptr;
+  }
+  return transports::IoContext::Get(std::stoul(getParameter(uri, "ioThreads", "1")));
+}
+
 std::unique_ptr<Transport> withUdpTransport(const http::url& uri) {
-  return std::make_unique<transports::UDP>(uri.host, uri.port);
+  return std::make_unique<transports::UDP>(uri.host, uri.port, getIoContext(uri),
+    std::stoul(getParameter(uri, "maxPending", "1024")),
+    std::chrono::seconds(std::stoul(getParameter(uri, "resolveInterval", "60"))));
 }
 
 std::unique_ptr<Transport> withUnixSocketTransport(const http::url& uri) {
-  return std::make_unique<transports::UnixSocket>(uri.path);
+  return std::make_unique<transports::UnixSocket>(uri.path, getIoContext(uri),
+    std::stoul(getParameter(uri, "maxPending", "1024")));
+}
+
+std::unique_ptr<Transport> withTcpTransport(const http::url& uri) {
+  return std::make_unique<transports::TCP>(uri.host, uri.port,
+    getParameter(uri, "nodelay", "1") != "0",
+    getParameter(uri, "cork", "0") != "0",
+    std::stoul(getParameter(uri, "bufferSize", "4194304"))
+  );
+}
+
+std::unique_ptr<Transport> withUnixStreamTransport(const http::url& uri) {
+  return std::make_unique<transports::UnixStream>(uri.path, std::stoul(getParameter(uri, "bufferSize", "4194304")));
 }
 #else
 std::unique_ptr<Transport> withUdpTransport(const http::url& /*uri*/) {
@@ -35,6 +81,14 @@ std::unique_ptr<Transport> withUdpTransport(const http::url& /*uri*/) {
 std::unique_ptr<Transport> withUnixSocketTransport(const http::url& /*uri*/) {
   throw InfluxDBException("InfluxDBFactory", "Unix socket transport requires Boost");
 }
+
+std::unique_ptr<Transport> withTcpTransport(const http::url& /*uri*/) {
+  throw InfluxDBException("InfluxDBFactory", "TCP transport requires Boost");
+}
+
+std::unique_ptr<Transport> withUnixStreamTransport(const http::url& /*uri*/) {
+  throw InfluxDBException("InfluxDBFactory", "Unix stream transport requires Boost");
+}
 #endif
 
 std::unique_ptr<Transport> withHttpTransport(const http::url& uri) {
@@ -43,18 +97,55 @@ std::unique_ptr<Transport> withHttpTransport(const http::url& uri) {
     transport->enableBasicAuth(uri.user + ":" + uri.password);
   }
 
+  auto token = getParameter(uri, "token");
+  if (!token.empty()) {
+    transport->enableTokenAuth(token);
+  }
+
+  if (getParameter(uri, "format") == "msgpack") {
+    transport->acceptMsgPack();
+  }
+
   if (uri.protocol == "https") {
     transport->enableSsl();
   }
   return transport;
 }
 
+std::unique_ptr<Transport> withNullTransport(const http::url& /*uri*/) {
+  return std::make_unique<transports::Null>();
+}
+
+std::unique_ptr<Transport> withMemoryTransport(const http::url& uri) {
+  return std::make_unique<transports::Memory>(uri.host, std::stoul(getParameter(uri, "capacity", "1024")));
+}
+
+std::unique_ptr<Transport> withFileTransport(const http::url& uri) {
+  return std::make_unique<transports::File>(uri.host + uri.path,
+    std::stoul(getParameter(uri, "rotateSize", "0")),
+    std::chrono::seconds(std::stoul(getParameter(uri, "rotateInterval", "0"))),
+    getParameter(uri, "compress") == "gzip",
+    std::stoul(getParameter(uri, "bufferSize", "1048576")),
+    std::chrono::milliseconds(std::stoul(getParameter(uri, "flushInterval", "1000")))
+  );
+}
+
+std::unique_ptr<Transport> withSharedMemoryTransport(const http::url& uri) {
+  return std::make_unique<transports::SharedMemory>(uri.host, std::stoul(getParameter(uri, "size", "16777216")));
+}
+
 std::unique_ptr<Transport> InfluxDBFactory::GetTransport(std::string url) {
   static const std::map<std::string, std::function<std::unique_ptr<Transport>(const http::url&)>> map = {
     {"udp", withUdpTransport},
     {"http", withHttpTransport},
     {"https", withHttpTransport},
     {"unix", withUnixSocketTransport},
+    {"tcp", withTcpTransport},
+    {"unix+stream", withUnixStreamTransport},
+    {"null", withNullTransport},
+    {"memory", withMemoryTransport},
+    {"file", withFileTransport},
+    {"shm", withSharedMemoryTransport},
   };
 
   http::url parsedUrl = http::ParseHttpUrl(url);
@@ -70,9 +161,70 @@ std::unique_ptr<Transport> InfluxDBFactory::GetTransport(std::string url) {
   return iterator->second(parsedUrl);
 }
 
+/// \return precision given by URI parameter (s, ms, us/u, ns/n), nanoseconds by default
+Precision getPrecision(const http::url& uri) {
+  static const std::map<std::string, Precision> precisions = {
+    {"s", Precision::Seconds},
+    {"ms", Precision::Milliseconds},
+    {"u", Precision::Microseconds},
+    {"us", Precision::Microseconds},
+    {"n", Precision::Nanoseconds},
+    {"ns", Precision::Nanoseconds},
+  };
+  auto precision = getParameter(uri, "precision", "ns");
+  auto iterator = precisions.find(precision);
+  if (iterator == precisions.end()) {
+    throw InfluxDBException("InfluxDBFactory", "Unrecognized precision " + precision);
+  }
+  return iterator->second;
+}
+
+/// Sets precision given by URI parameter of all URLs, points are serialized once for all of them
+/// \throw InfluxDBException if URLs request different precisions
+void applyPrecision(InfluxDB& influxdb, const std::vector<std::string>& urls) {
+  auto precision = Precision::Nanoseconds;
+  bool first = true;
+  for (const auto& url : urls) {
+    auto parsed = url;
+    auto requested = getPrecision(http::ParseHttpUrl(parsed));
+    if (!first && requested != precision) {
+      throw InfluxDBException("InfluxDBFactory", "Conflicting precision of " + url);
+    }
+    precision = requested;
+    first = false;
+  }
+  if (precision != Precision::Nanoseconds) {
+    influxdb.setPrecision(precision);
+  }
+}
+
 std::unique_ptr<InfluxDB> InfluxDBFactory::Get(std::string url)
 {
-  return std::make_unique<InfluxDB>(InfluxDBFactory::GetTransport(url));
+  auto influxdb = std::make_unique<InfluxDB>(InfluxDBFactory::GetTransport(url));
+  applyPrecision(*influxdb, {url});
+  return influxdb;
+}
+
+std::unique_ptr<InfluxDB> InfluxDBFactory::GetSharded(const std::vector<std::string>& urls)
+{
+  std::vector<std::pair<std::string, std::unique_ptr<Transport>>> shards;
+  for (const auto& url : urls) {
+    shards.emplace_back(url, InfluxDBFactory::GetTransport(url));
+  }
+  auto influxdb = std::make_unique<InfluxDB>(std::make_unique<transports::Sharded>(std::move(shards)));
+  applyPrecision(*influxdb, urls);
+  return influxdb;
+}
+
+std::unique_ptr<InfluxDB> InfluxDBFactory::GetReplicated(const std::vector<std::string>& urls)
+{
+  std::vector<std::unique_ptr<Transport>> destinations;
+  for (const auto& url : urls) {
+    destinations.push_back(InfluxDBFactory::GetTransport(url));
+  }
+  auto influxdb = std::make_unique<InfluxDB>(std::make_unique<transports::Replicated>(std::move(destinations)));
+  applyPrecision(*influxdb, urls);
+  return influxdb;
 }
 
 } // namespace influxdb
@@ -0,0 +1,62 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "IoContext.h"
+
+#include <mutex>
+
+namespace influxdb
+{
+namespace transports
+{
+
+IoContext::IoContext(std::size_t threads) :
+  mWork(boost::asio::make_work_guard(mContext))
+{
+  for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); i++) {
+    mThreads.emplace_back([this] { mContext.run(); });
+  }
+}
+
+IoContext::~IoContext()
+{
+  mWork.reset();
+  mContext.stop();
+  for (auto& thread : mThreads) {
+    thread.join();
+  }
+}
+
+std::shared_ptr<IoContext> IoContext::Get(std::size_t threads)
+{
+  static std::mutex mutex;
+  static std::weak_ptr<IoContext> shared;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto context = shared.lock();
+  if (!context) {
+    context = std::shared_ptr<IoContext>(new IoContext(threads), [](IoContext* released) {
+      // last reference dropped by a handler: an I/O thread can neither join itself nor outlive the context it runs
+      if (released->mContext.get_executor().running_in_this_thread()) {
+        std::thread([released] { delete released; }).detach();
+      } else {
+        delete released;
+      }
+    });
+    shared = context;
+  }
+  return context;
+}
+
+boost::asio::io_context& IoContext::get()
+{
+  return mContext;
+}
+
+std::size_t IoContext::threads() const
+{
+  return mThreads.size();
+}
+
+} // namespace transports
+} // namespace influxdb
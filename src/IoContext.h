@@ -0,0 +1,53 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_IOCONTEXT_H
+#define INFLUXDATA_TRANSPORTS_IOCONTEXT_H
+
+#include <boost/asio.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief Boost Asio io_context run by a fixed set of threads, shared by asynchronous transports
+class IoContext
+{
+  public:
+    /// Starts threads running the context
+    IoContext(std::size_t threads);
+
+    /// Stops and joins the threads, pending operations are abandoned; must not run on an I/O thread
+    ~IoContext();
+
+    /// \return process-wide context, started with given number of threads unless already running;
+    ///         it stops once the last transport using it is destroyed (from another thread when the last
+    ///         reference is released on an I/O thread)
+    static std::shared_ptr<IoContext> Get(std::size_t threads = 1);
+
+    /// \return underlying context
+    boost::asio::io_context& get();
+
+    /// \return number of I/O threads
+    std::size_t threads() const;
+
+  private:
+    /// Boost Asio I/O functionality
+    boost::asio::io_context mContext;
+
+    /// Keeps threads running when there is no work
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> mWork;
+
+    /// I/O threads
+    std::vector<std::thread> mThreads;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_IOCONTEXT_H
@@ -0,0 +1,287 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "JsonDecoder.h"
+#include "InfluxDBException.h"
+
+#include <charconv>
+
+namespace influxdb
+{
+
+JsonDecoder::JsonDecoder(std::string_view json, ResultBuilder& builder) :
+  mJson(json), mPosition(0), mBuilder(builder)
+{
+}
+
+void JsonDecoder::Decode(std::string_view json, ResultBuilder& builder)
+{
+  JsonDecoder decoder(json, builder);
+  decoder.response();
+}
+
+void JsonDecoder::fail(const std::string& message) const
+{
+  throw InfluxDBException("JsonDecoder", message + " at offset " + std::to_string(mPosition));
+}
+
+char JsonDecoder::peek()
+{
+  while (mPosition < mJson.size()) {
+    char character = mJson[mPosition];
+    if (character != ' ' && character != '\n' && character != '\r' && character != '\t') {
+      return character;
+    }
+    mPosition++;
+  }
+  return 0;
+}
+
+void JsonDecoder::expect(char character)
+{
+  if (peek() != character) {
+    fail(std::string("Expected '") + character + "'");
+  }
+  mPosition++;
+}
+
+template<typename Function>
+void JsonDecoder::object(Function member)
+{
+  expect('{');
+  if (peek() == '}') {
+    mPosition++;
+    return;
+  }
+  for (;;) {
+    auto key = string();
+    expect(':');
+    member(key);
+    if (peek() == ',') {
+      mPosition++;
+      continue;
+    }
+    expect('}');
+    return;
+  }
+}
+
+template<typename Function>
+void JsonDecoder::array(Function element)
+{
+  expect('[');
+  if (peek() == ']') {
+    mPosition++;
+    return;
+  }
+  for (;;) {
+    element();
+    if (peek() == ',') {
+      mPosition++;
+      continue;
+    }
+    expect(']');
+    return;
+  }
+}
+
+std::string_view JsonDecoder::string()
+{
+  expect('"');
+  auto start = mPosition;
+  auto end = mJson.find_first_of("\"\\", start);
+  if (end == std::string_view::npos) {
+    fail("Unterminated string");
+  }
+  if (mJson[end] == '"') {
+    mPosition = end + 1;
+    return mJson.substr(start, end - start);
+  }
+
+  mScratch.assign(mJson.data() + start, end - start);
+  mPosition = end;
+  while (mPosition < mJson.size()) {
+    char character = mJson[mPosition++];
+    if (character == '"') {
+      return mScratch;
+    }
+    if (character != '\\') {
+      mScratch += character;
+      continue;
+    }
+    if (mPosition >= mJson.size()) break;
+    character = mJson[mPosition++];
+    switch (character) {
+      case 'b': mScratch += '\b'; break;
+      case 'f': mScratch += '\f'; break;
+      case 'n': mScratch += '\n'; break;
+      case 'r': mScratch += '\r'; break;
+      case 't': mScratch += '\t'; break;
+      case 'u': {
+        auto hex = [this](unsigned int& code) {
+          if (mPosition + 4 > mJson.size()) return false;
+          auto result = std::from_chars(mJson.data() + mPosition, mJson.data() + mPosition + 4, code, 16);
+          mPosition += 4;
+          return result.ptr == mJson.data() + mPosition;
+        };
+        unsigned int code = 0;
+        if (!hex(code)) fail("Invalid unicode escape");
+        if (code >= 0xD800 && code <= 0xDBFF && mJson.substr(mPosition, 2) == "\\u") {
+          unsigned int low = 0;
+          mPosition += 2;
+          if (!hex(low)) fail("Invalid unicode escape");
+          code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        if (code < 0x80) {
+          mScratch += static_cast<char>(code);
+        } else if (code < 0x800) {
+          mScratch += static_cast<char>(0xC0 | (code >> 6));
+          mScratch += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+          mScratch += static_cast<char>(0xE0 | (code >> 12));
+          mScratch += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+          mScratch += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+          mScratch += static_cast<char>(0xF0 | (code >> 18));
+          mScratch += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+          mScratch += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+          mScratch += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        break;
+      }
+      default: mScratch += character;
+    }
+  }
+  fail("Unterminated string");
+}
+
+void JsonDecoder::skip()
+{
+  switch (peek()) {
+    case '{':
+      object([this](std::string_view) { skip(); });
+      return;
+    case '[':
+      array([this] { skip(); });
+      return;
+    case '"':
+      string();
+      return;
+    default:
+      auto end = mJson.find_first_of(",}] \n\r\t", mPosition);
+      if (end == mPosition) fail("Unexpected character");
+      mPosition = (end == std::string_view::npos) ? mJson.size() : end;
+  }
+}
+
+void JsonDecoder::cell()
+{
+  char character = peek();
+  if (character == '"') {
+    mBuilder.value(string());
+    return;
+  }
+  if (character == '{' || character == '[') {
+    skip();
+    mBuilder.value(nullptr);
+    return;
+  }
+  auto start = mPosition;
+  auto end = mJson.find_first_of(",] \n\r\t", start);
+  if (end == std::string_view::npos) fail("Unterminated value");
+  auto token = mJson.substr(start, end - start);
+  mPosition = end;
+
+  if (token == "null") {
+    mBuilder.value(nullptr);
+  } else if (token == "true") {
+    mBuilder.value(true);
+  } else if (token == "false") {
+    mBuilder.value(false);
+  } else {
+    const char* last = token.data() + token.size();
+    // JSON does not tell integers from floats, only epoch timestamps need exact integers
+    if (token.find_first_of(".eE") == std::string_view::npos) {
+      long long int integer;
+      auto result = std::from_chars(token.data(), last, integer);
+      if (result.ec == std::errc() && result.ptr == last) {
+        mBuilder.number(integer);
+        return;
+      }
+    }
+    double number;
+    auto result = std::from_chars(token.data(), last, number);
+    if (result.ec != std::errc() || result.ptr != last) {
+      fail("Invalid value");
+    }
+    mBuilder.value(number);
+  }
+}
+
+void JsonDecoder::row()
+{
+  mBuilder.row();
+  array([this] { cell(); });
+}
+
+void JsonDecoder::series()
+{
+  mBuilder.series();
+  object([this](std::string_view key) {
+    if (key == "name") {
+      mBuilder.name(string());
+    } else if (key == "tags") {
+      object([this](std::string_view tagKey) {
+        std::string name(tagKey);
+        if (peek() == '"') {
+          mBuilder.tag(name, string());
+        } else {
+          skip();
+          mBuilder.tag(name, "");
+        }
+      });
+    } else if (key == "columns") {
+      array([this] { mBuilder.column(string()); });
+    } else if (key == "values") {
+      array([this] { row(); });
+    } else {
+      skip();
+    }
+  });
+}
+
+void JsonDecoder::result()
+{
+  object([this](std::string_view key) {
+    if (key == "statement_id") {
+      peek();
+      auto start = mPosition;
+      skip();
+      int id = 0;
+      std::from_chars(mJson.data() + start, mJson.data() + mPosition, id);
+      mBuilder.statement(id);
+    } else if (key == "series") {
+      array([this] { series(); });
+    } else if (key == "error") {
+      mBuilder.statementError(string());
+    } else {
+      skip();
+    }
+  });
+}
+
+void JsonDecoder::response()
+{
+  object([this](std::string_view key) {
+    if (key == "results") {
+      array([this] { result(); });
+    } else if (key == "error") {
+      mBuilder.error(string());
+    } else {
+      skip();
+    }
+  });
+}
+
+} // namespace influxdb
@@ -0,0 +1,82 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_JSONDECODER_H
+#define INFLUXDATA_JSONDECODER_H
+
+#include "ResultBuilder.h"
+
+#include <string>
+#include <string_view>
+
+namespace influxdb
+{
+
+/// \brief Decodes InfluxDB JSON query response straight into ResultBuilder, without a document tree
+/// Keeps JSON value types (string, integer, float, bool, null); no exceptions on the hot path
+class JsonDecoder
+{
+  public:
+    /// Decodes response
+    /// \throw InfluxDBException	if response is malformed or reports an error
+    static void Decode(std::string_view json, ResultBuilder& builder);
+
+  private:
+    /// Constructor
+    JsonDecoder(std::string_view json, ResultBuilder& builder);
+
+    /// Top level object
+    void response();
+
+    /// Statement result object
+    void result();
+
+    /// Series object
+    void series();
+
+    /// Row of values
+    void row();
+
+    /// Cell value
+    void cell();
+
+    /// Parses string, unescaping into scratch buffer when needed
+    std::string_view string();
+
+    /// Skips any value
+    void skip();
+
+    /// Iterates over object members
+    template<typename Function>
+    void object(Function member);
+
+    /// Iterates over array elements
+    template<typename Function>
+    void array(Function element);
+
+    /// Skips whitespace, \return next character or 0 at end
+    char peek();
+
+    /// Consumes expected character
+    void expect(char character);
+
+    /// Throws decoding error
+    [[noreturn]] void fail(const std::string& message) const;
+
+    /// Input
+    std::string_view mJson;
+
+    /// Current position
+    std::size_t mPosition;
+
+    /// Output
+    ResultBuilder& mBuilder;
+
+    /// Unescaped string storage
+    std::string mScratch;
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_JSONDECODER_H
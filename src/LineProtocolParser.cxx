@@ -0,0 +1,297 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "LineProtocolParser.h"
+#include "InfluxDBException.h"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace influxdb
+{
+
+namespace
+{
+
+/// \return whether character is one of C
+template<char... C>
+inline bool isAny(char character)
+{
+  return ((character == C) || ...);
+}
+
+/// \return first position in [position, end) holding one of C, end if none
+template<char... C>
+inline const char* findAny(const char* position, const char* end)
+{
+#ifdef __SSE2__
+  while (end - position >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+    __m128i match = _mm_setzero_si128();
+    ((match = _mm_or_si128(match, _mm_cmpeq_epi8(chunk, _mm_set1_epi8(C)))), ...);
+    int mask = _mm_movemask_epi8(match);
+    if (mask != 0) {
+      return position + __builtin_ctz(mask);
+    }
+    position += 16;
+  }
+#endif
+  while (position < end && !isAny<C...>(*position)) {
+    position++;
+  }
+  return position;
+}
+
+/// \return first unescaped position holding one of C, end if none
+template<char... C>
+inline const char* scan(const char* position, const char* end)
+{
+  for (;;) {
+    position = findAny<C..., '\\'>(position, end);
+    if (position == end || *position != '\\') {
+      return position;
+    }
+    position += 2;
+    if (position >= end) {
+      return end;
+    }
+  }
+}
+
+/// Parses whole text as number
+template<typename T>
+bool parseNumber(std::string_view text, T& value)
+{
+  auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+  return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+} // namespace
+
+LineProtocolParser::LineProtocolParser(std::string_view data) :
+  mPosition(data.data()), mEnd(data.data() + data.size()), mLineNumber(0)
+{
+}
+
+std::size_t LineProtocolParser::lineNumber() const
+{
+  return mLineNumber;
+}
+
+void LineProtocolParser::fail(const std::string& message) const
+{
+  throw InfluxDBException("LineProtocolParser", "Line " + std::to_string(mLineNumber) + ": " + message);
+}
+
+bool LineProtocolParser::next(Record& record)
+{
+  while (mPosition < mEnd) {
+    auto begin = mPosition;
+    auto end = static_cast<const char*>(std::memchr(begin, '\n', mEnd - begin));
+    if (end == nullptr) {
+      end = mEnd;
+    }
+    mPosition = end < mEnd ? end + 1 : mEnd;
+    mLineNumber++;
+    if (end > begin && end[-1] == '\r') {
+      end--;
+    }
+    while (begin < end && (*begin == ' ' || *begin == '\t')) {
+      begin++;
+    }
+    if (begin == end || *begin == '#') {
+      continue;
+    }
+    parse(begin, end, record);
+    return true;
+  }
+  return false;
+}
+
+void LineProtocolParser::parse(const char* begin, const char* end, Record& record)
+{
+  record.line = std::string_view(begin, end - begin);
+  record.tags.clear();
+  record.fields.clear();
+
+  auto position = scan<',', ' '>(begin, end);
+  if (position == begin) {
+    fail("Missing measurement");
+  }
+  record.measurement = std::string_view(begin, position - begin);
+
+  while (position < end && *position == ',') {
+    auto key = position + 1;
+    auto separator = scan<'=', ',', ' '>(key, end);
+    if (separator == key || separator == end || *separator != '=') {
+      fail("Invalid tag");
+    }
+    auto value = separator + 1;
+    position = scan<',', ' '>(value, end);
+    if (position == value) {
+      fail("Empty tag value");
+    }
+    record.tags.push_back({{key, static_cast<std::size_t>(separator - key)},
+      {value, static_cast<std::size_t>(position - value)}});
+  }
+  if (position == end) {
+    fail("Missing fields");
+  }
+
+  do {
+    auto key = position + 1;
+    auto separator = scan<'=', ',', ' '>(key, end);
+    if (separator == key || separator == end || *separator != '=') {
+      fail("Invalid field");
+    }
+    Field field;
+    field.key = std::string_view(key, separator - key);
+    auto value = separator + 1;
+    if (value < end && *value == '"') {
+      position = value + 1;
+      for (;;) {
+        position = findAny<'"', '\\'>(position, end);
+        if (position == end) {
+          fail("Unterminated string");
+        }
+        if (*position == '"') {
+          break;
+        }
+        position += 2;
+        if (position >= end) {
+          fail("Unterminated string");
+        }
+      }
+      field.type = FieldType::String;
+      field.string = std::string_view(value + 1, position - value - 1);
+      position++;
+    } else {
+      position = findAny<',', ' '>(value, end);
+      parseValue(std::string_view(value, position - value), field);
+    }
+    record.fields.push_back(field);
+  } while (position < end && *position == ',');
+
+  record.hasTimestamp = false;
+  record.timestamp = 0;
+  if (position == end) {
+    return;
+  }
+  if (*position != ' ') {
+    fail("Unexpected character after field");
+  }
+  while (position < end && *position == ' ') {
+    position++;
+  }
+  auto timestampEnd = end;
+  while (timestampEnd > position && timestampEnd[-1] == ' ') {
+    timestampEnd--;
+  }
+  if (position == timestampEnd) {
+    return;
+  }
+  if (!parseNumber(std::string_view(position, timestampEnd - position), record.timestamp)) {
+    fail("Invalid timestamp");
+  }
+  record.hasTimestamp = true;
+}
+
+void LineProtocolParser::parseValue(std::string_view text, Field& field)
+{
+  field.string = text;
+  if (text.empty()) {
+    fail("Empty field value");
+  }
+  auto last = text.back();
+  if (last == 'i') {
+    field.type = FieldType::Integer;
+    if (!parseNumber(text.substr(0, text.size() - 1), field.integerValue)) {
+      fail("Invalid integer");
+    }
+    return;
+  }
+  if (last == 'u') {
+    field.type = FieldType::Unsigned;
+    if (!parseNumber(text.substr(0, text.size() - 1), field.unsignedValue)) {
+      fail("Invalid unsigned integer");
+    }
+    return;
+  }
+  if (text == "t" || text == "T" || text == "true" || text == "True" || text == "TRUE") {
+    field.type = FieldType::Boolean;
+    field.booleanValue = true;
+    return;
+  }
+  if (text == "f" || text == "F" || text == "false" || text == "False" || text == "FALSE") {
+    field.type = FieldType::Boolean;
+    field.booleanValue = false;
+    return;
+  }
+  field.type = FieldType::Float;
+  if (!parseNumber(text, field.floatValue)) {
+    fail("Invalid value");
+  }
+}
+
+std::string LineProtocolParser::Unescape(std::string_view escaped)
+{
+  std::string unescaped;
+  unescaped.reserve(escaped.size());
+  for (std::size_t i = 0; i < escaped.size(); i++) {
+    if (escaped[i] == '\\' && i + 1 < escaped.size() && isAny<',', '=', ' ', '"', '\\'>(escaped[i + 1])) {
+      i++;
+    }
+    unescaped += escaped[i];
+  }
+  return unescaped;
+}
+
+LineProtocolParser::MappedFile::MappedFile(const std::string& path) :
+  mAddress(nullptr), mSize(0)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw InfluxDBException("LineProtocolParser::MappedFile", "Cannot open " + path + ": " + std::strerror(errno));
+  }
+  struct stat status{};
+  if (fstat(fd, &status) != 0) {
+    close(fd);
+    throw InfluxDBException("LineProtocolParser::MappedFile", "Cannot stat " + path + ": " + std::strerror(errno));
+  }
+  mSize = status.st_size;
+  if (mSize > 0) {
+    mAddress = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (mAddress == MAP_FAILED) {
+    throw InfluxDBException("LineProtocolParser::MappedFile", "Cannot map " + path + ": " + std::strerror(errno));
+  }
+  if (mAddress != nullptr) {
+    madvise(mAddress, mSize, MADV_SEQUENTIAL);
+  }
+}
+
+LineProtocolParser::MappedFile::~MappedFile()
+{
+  if (mAddress != nullptr) {
+    munmap(mAddress, mSize);
+  }
+}
+
+std::string_view LineProtocolParser::MappedFile::data() const
+{
+  return {static_cast<const char*>(mAddress), mSize};
+}
+
+} // namespace influxdb
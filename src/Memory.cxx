@@ -0,0 +1,136 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "Memory.h"
+#include "InfluxDBException.h"
+
+#include <map>
+#include <mutex>
+
+namespace influxdb
+{
+namespace transports
+{
+
+struct Memory::Ring
+{
+  Ring(std::size_t capacity) : slots(capacity > 0 ? capacity : 1), head(0), size(0), dropped(0) {}
+
+  std::vector<std::string> copy() const
+  {
+    std::vector<std::string> messages;
+    messages.reserve(size);
+    for (std::size_t i = 0; i < size; i++) {
+      messages.push_back(slots[(head + i) % slots.size()]);
+    }
+    return messages;
+  }
+
+  std::vector<std::string> drain()
+  {
+    std::vector<std::string> messages;
+    messages.reserve(size);
+    for (std::size_t i = 0; i < size; i++) {
+      messages.push_back(std::move(slots[(head + i) % slots.size()]));
+    }
+    head = 0;
+    size = 0;
+    return messages;
+  }
+
+  mutable std::mutex mutex;
+  std::vector<std::string> slots;
+  std::size_t head;
+  std::size_t size;
+  std::size_t dropped;
+};
+
+namespace
+{
+std::mutex registryMutex;
+std::map<std::string, std::shared_ptr<Memory::Ring>>& registry()
+{
+  static std::map<std::string, std::shared_ptr<Memory::Ring>> rings;
+  return rings;
+}
+} // namespace
+
+Memory::Memory(const std::string& name, std::size_t capacity)
+{
+  if (name.empty()) {
+    mRing = std::make_shared<Ring>(capacity);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(registryMutex);
+  auto& ring = registry()[name];
+  if (!ring) {
+    ring = std::make_shared<Ring>(capacity);
+  }
+  mRing = ring;
+}
+
+void Memory::send(std::string&& message)
+{
+  std::lock_guard<std::mutex> lock(mRing->mutex);
+  auto capacity = mRing->slots.size();
+  if (mRing->size < capacity) {
+    mRing->slots[(mRing->head + mRing->size) % capacity] = std::move(message);
+    mRing->size++;
+  } else {
+    mRing->slots[mRing->head] = std::move(message);
+    mRing->head = (mRing->head + 1) % capacity;
+    mRing->dropped++;
+  }
+}
+
+std::vector<std::string> Memory::read() const
+{
+  std::lock_guard<std::mutex> lock(mRing->mutex);
+  return mRing->copy();
+}
+
+std::vector<std::string> Memory::drain()
+{
+  std::lock_guard<std::mutex> lock(mRing->mutex);
+  return mRing->drain();
+}
+
+std::size_t Memory::dropped() const
+{
+  std::lock_guard<std::mutex> lock(mRing->mutex);
+  return mRing->dropped;
+}
+
+std::shared_ptr<Memory::Ring> Memory::Find(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(registryMutex);
+  auto iterator = registry().find(name);
+  if (iterator == registry().end()) {
+    throw InfluxDBException("Memory::Find", "Unknown ring " + name);
+  }
+  return iterator->second;
+}
+
+std::vector<std::string> Memory::Read(const std::string& name)
+{
+  auto ring = Find(name);
+  std::lock_guard<std::mutex> lock(ring->mutex);
+  return ring->copy();
+}
+
+std::vector<std::string> Memory::Drain(const std::string& name)
+{
+  auto ring = Find(name);
+  std::lock_guard<std::mutex> lock(ring->mutex);
+  return ring->drain();
+}
+
+void Memory::Release(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(registryMutex);
+  registry().erase(name);
+}
+
+} // namespace transports
+} // namespace influxdb
@@ -0,0 +1,306 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "MsgPackDecoder.h"
+#include "InfluxDBException.h"
+
+#include <climits>
+#include <cstring>
+#include <type_traits>
+
+namespace influxdb
+{
+
+namespace
+{
+
+/// Time extension type of InfluxDB (tinylib/msgp): int64 seconds, int32 nanoseconds
+constexpr std::int8_t TimeExtension = 5;
+
+/// Timestamp extension type of MessagePack specification
+constexpr std::int8_t TimestampExtension = -1;
+
+std::chrono::time_point<std::chrono::system_clock> toTimePoint(long long int seconds, long long int nanoseconds)
+{
+  return std::chrono::time_point<std::chrono::system_clock>(
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+      std::chrono::seconds(seconds) + std::chrono::nanoseconds(nanoseconds)));
+}
+
+} // namespace
+
+MsgPackDecoder::MsgPackDecoder(std::string_view data, ResultBuilder& builder) :
+  mData(data), mPosition(0), mBuilder(builder)
+{
+}
+
+void MsgPackDecoder::Decode(std::string_view data, ResultBuilder& builder)
+{
+  MsgPackDecoder decoder(data, builder);
+  decoder.response();
+}
+
+bool MsgPackDecoder::Detect(std::string_view data)
+{
+  if (data.empty()) {
+    return false;
+  }
+  auto type = static_cast<std::uint8_t>(data[0]);
+  return (type & 0xf0) == 0x80 || type == 0xde || type == 0xdf;
+}
+
+void MsgPackDecoder::fail(const std::string& message) const
+{
+  throw InfluxDBException("MsgPackDecoder", message + " at offset " + std::to_string(mPosition));
+}
+
+std::string_view MsgPackDecoder::bytes(std::size_t size)
+{
+  if (mData.size() - mPosition < size) {
+    fail("Unexpected end of input");
+  }
+  auto view = mData.substr(mPosition, size);
+  mPosition += size;
+  return view;
+}
+
+std::uint8_t MsgPackDecoder::byte()
+{
+  return static_cast<std::uint8_t>(bytes(1)[0]);
+}
+
+template<typename T>
+T MsgPackDecoder::number()
+{
+  std::uint64_t value = 0;
+  for (auto character : bytes(sizeof(T))) {
+    value = (value << 8) | static_cast<std::uint8_t>(character);
+  }
+  if constexpr (std::is_floating_point_v<T>) {
+    std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t> bits = value;
+    T result;
+    std::memcpy(&result, &bits, sizeof(T));
+    return result;
+  } else {
+    return static_cast<T>(value);
+  }
+}
+
+std::size_t MsgPackDecoder::map()
+{
+  auto type = byte();
+  if ((type & 0xf0) == 0x80) return type & 0x0f;
+  if (type == 0xde) return number<std::uint16_t>();
+  if (type == 0xdf) return number<std::uint32_t>();
+  mPosition--;
+  fail("Expected map");
+}
+
+std::size_t MsgPackDecoder::array()
+{
+  auto type = byte();
+  if ((type & 0xf0) == 0x90) return type & 0x0f;
+  if (type == 0xdc) return number<std::uint16_t>();
+  if (type == 0xdd) return number<std::uint32_t>();
+  mPosition--;
+  fail("Expected array");
+}
+
+std::string_view MsgPackDecoder::string()
+{
+  auto type = byte();
+  if ((type & 0xe0) == 0xa0) return bytes(type & 0x1f);
+  if (type == 0xd9) return bytes(number<std::uint8_t>());
+  if (type == 0xda) return bytes(number<std::uint16_t>());
+  if (type == 0xdb) return bytes(number<std::uint32_t>());
+  if (type == 0xc0) return {};
+  mPosition--;
+  fail("Expected string");
+}
+
+long long int MsgPackDecoder::integer()
+{
+  auto type = byte();
+  if (type <= 0x7f) return type;
+  if (type >= 0xe0) return static_cast<std::int8_t>(type);
+  switch (type) {
+    case 0xcc: return number<std::uint8_t>();
+    case 0xcd: return number<std::uint16_t>();
+    case 0xce: return number<std::uint32_t>();
+    case 0xcf: return static_cast<long long int>(number<std::uint64_t>());
+    case 0xd0: return number<std::int8_t>();
+    case 0xd1: return number<std::int16_t>();
+    case 0xd2: return number<std::int32_t>();
+    case 0xd3: return number<std::int64_t>();
+  }
+  mPosition--;
+  fail("Expected integer");
+}
+
+void MsgPackDecoder::skip()
+{
+  auto type = byte();
+  if (type <= 0x7f || type >= 0xe0 || type == 0xc0 || type == 0xc2 || type == 0xc3) return;
+  if ((type & 0xe0) == 0xa0) { bytes(type & 0x1f); return; }
+  if ((type & 0xf0) == 0x80 || type == 0xde || type == 0xdf) {
+    mPosition--;
+    for (auto entries = map() * 2; entries > 0; entries--) skip();
+    return;
+  }
+  if ((type & 0xf0) == 0x90 || type == 0xdc || type == 0xdd) {
+    mPosition--;
+    for (auto elements = array(); elements > 0; elements--) skip();
+    return;
+  }
+  switch (type) {
+    case 0xc4: case 0xd9: bytes(number<std::uint8_t>()); return;
+    case 0xc5: case 0xda: bytes(number<std::uint16_t>()); return;
+    case 0xc6: case 0xdb: bytes(number<std::uint32_t>()); return;
+    case 0xc7: bytes(number<std::uint8_t>() + 1); return;
+    case 0xc8: bytes(number<std::uint16_t>() + 1); return;
+    case 0xc9: bytes(std::size_t{number<std::uint32_t>()} + 1); return;
+    case 0xcc: case 0xd0: bytes(1); return;
+    case 0xcd: case 0xd1: bytes(2); return;
+    case 0xca: case 0xce: case 0xd2: bytes(4); return;
+    case 0xcb: case 0xcf: case 0xd3: bytes(8); return;
+    case 0xd4: bytes(2); return;
+    case 0xd5: bytes(3); return;
+    case 0xd6: bytes(5); return;
+    case 0xd7: bytes(9); return;
+    case 0xd8: bytes(17); return;
+  }
+  mPosition--;
+  fail("Invalid type");
+}
+
+void MsgPackDecoder::cell()
+{
+  auto type = static_cast<std::uint8_t>(mPosition < mData.size() ? mData[mPosition] : 0xc1);
+  if (type <= 0x7f || type >= 0xe0 || (type >= 0xcc && type <= 0xd3 && type != 0xcf)) {
+    mBuilder.value(integer());
+    return;
+  }
+  if ((type & 0xe0) == 0xa0 || (type >= 0xd9 && type <= 0xdb)) {
+    mBuilder.value(string());
+    return;
+  }
+  mPosition++;
+  switch (type) {
+    case 0xc0: mBuilder.value(nullptr); return;
+    case 0xc2: mBuilder.value(false); return;
+    case 0xc3: mBuilder.value(true); return;
+    case 0xca: mBuilder.value(static_cast<double>(number<float>())); return;
+    case 0xcb: mBuilder.value(number<double>()); return;
+    case 0xcf: {
+      auto value = number<std::uint64_t>();
+      if (value <= static_cast<std::uint64_t>(LLONG_MAX)) {
+        mBuilder.value(static_cast<long long int>(value));
+      } else {
+        mBuilder.value(static_cast<unsigned long long int>(value));
+      }
+      return;
+    }
+    case 0xc7: {
+      auto size = number<std::uint8_t>();
+      auto extension = number<std::int8_t>();
+      if (extension == TimeExtension && size == 12) {
+        auto seconds = number<std::int64_t>();
+        mBuilder.timestamp(toTimePoint(seconds, number<std::int32_t>()));
+      } else if (extension == TimestampExtension && size == 12) {
+        auto nanoseconds = number<std::uint32_t>();
+        mBuilder.timestamp(toTimePoint(number<std::int64_t>(), nanoseconds));
+      } else {
+        bytes(size);
+        mBuilder.value(nullptr);
+      }
+      return;
+    }
+    case 0xd6:
+      if (number<std::int8_t>() == TimestampExtension) {
+        mBuilder.timestamp(toTimePoint(number<std::uint32_t>(), 0));
+      } else {
+        bytes(4);
+        mBuilder.value(nullptr);
+      }
+      return;
+    case 0xd7:
+      if (number<std::int8_t>() == TimestampExtension) {
+        auto value = number<std::uint64_t>();
+        mBuilder.timestamp(toTimePoint(static_cast<long long int>(value & 0x3ffffffffULL), value >> 34));
+      } else {
+        bytes(8);
+        mBuilder.value(nullptr);
+      }
+      return;
+  }
+  // binary, nested containers and other extensions are not field values
+  mPosition--;
+  skip();
+  mBuilder.value(nullptr);
+}
+
+void MsgPackDecoder::series()
+{
+  mBuilder.series();
+  for (auto entries = map(); entries > 0; entries--) {
+    auto key = string();
+    if (key == "name") {
+      mBuilder.name(string());
+    } else if (key == "tags") {
+      for (auto tags = map(); tags > 0; tags--) {
+        auto tagKey = string();
+        mBuilder.tag(tagKey, string());
+      }
+    } else if (key == "columns") {
+      for (auto columns = array(); columns > 0; columns--) {
+        mBuilder.column(string());
+      }
+    } else if (key == "values") {
+      for (auto rows = array(); rows > 0; rows--) {
+        mBuilder.row();
+        for (auto cells = array(); cells > 0; cells--) {
+          cell();
+        }
+      }
+    } else {
+      skip();
+    }
+  }
+}
+
+void MsgPackDecoder::result()
+{
+  for (auto entries = map(); entries > 0; entries--) {
+    auto key = string();
+    if (key == "id" || key == "statement_id") {
+      mBuilder.statement(static_cast<int>(integer()));
+    } else if (key == "series") {
+      for (auto series = array(); series > 0; series--) {
+        this->series();
+      }
+    } else if (key == "error") {
+      mBuilder.statementError(string());
+    } else {
+      skip();
+    }
+  }
+}
+
+void MsgPackDecoder::response()
+{
+  for (auto entries = map(); entries > 0; entries--) {
+    auto key = string();
+    if (key == "results") {
+      for (auto results = array(); results > 0; results--) {
+        result();
+      }
+    } else if (key == "error") {
+      mBuilder.error(string());
+    } else {
+      skip();
+    }
+  }
+}
+
+} // namespace influxdb
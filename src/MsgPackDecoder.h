@@ -0,0 +1,84 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_MSGPACKDECODER_H
+#define INFLUXDATA_MSGPACKDECODER_H
+
+#include "ResultBuilder.h"
+
+#include <cstdint>
+#include <string_view>
+
+namespace influxdb
+{
+
+/// \brief Decodes InfluxDB MessagePack query response (Accept: application/x-msgpack) into ResultBuilder
+/// Strings are passed as views into the input; time extension values (type 5) set point timestamp
+class MsgPackDecoder
+{
+  public:
+    /// Decodes response
+    /// \throw InfluxDBException	if response is malformed or reports an error
+    static void Decode(std::string_view data, ResultBuilder& builder);
+
+    /// \return whether response is MessagePack encoded (starts with a map, JSON starts with '{')
+    static bool Detect(std::string_view data);
+
+  private:
+    /// Constructor
+    MsgPackDecoder(std::string_view data, ResultBuilder& builder);
+
+    /// Top level map
+    void response();
+
+    /// Statement result map
+    void result();
+
+    /// Series map
+    void series();
+
+    /// Cell value
+    void cell();
+
+    /// \return number of map entries
+    std::size_t map();
+
+    /// \return number of array elements
+    std::size_t array();
+
+    /// \return string value
+    std::string_view string();
+
+    /// \return integer value
+    long long int integer();
+
+    /// Skips any value
+    void skip();
+
+    /// \return next byte
+    std::uint8_t byte();
+
+    /// \return big endian number
+    template<typename T>
+    T number();
+
+    /// \return next bytes
+    std::string_view bytes(std::size_t size);
+
+    /// Throws decoding error
+    [[noreturn]] void fail(const std::string& message) const;
+
+    /// Input
+    std::string_view mData;
+
+    /// Current position
+    std::size_t mPosition;
+
+    /// Output
+    ResultBuilder& mBuilder;
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_MSGPACKDECODER_H
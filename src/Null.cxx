@@ -0,0 +1,21 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "Null.h"
+
+namespace influxdb
+{
+namespace transports
+{
+
+void Null::send(std::string&& /*message*/)
+{
+}
+
+void Null::sendShared(const std::shared_ptr<const std::string>& /*message*/)
+{
+}
+
+} // namespace transports
+} // namespace influxdb
@@ -0,0 +1,37 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_NULL_H
+#define INFLUXDATA_TRANSPORTS_NULL_H
+
+#include "Transport.h"
+
+#include <string>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief Transport discarding all messages (dry runs, serialization benchmarks)
+class Null : public Transport
+{
+  public:
+    /// Default constructor
+    Null() = default;
+
+    /// Default destructor
+    ~Null() = default;
+
+    /// Discards message
+    void send(std::string&& message) override;
+
+    /// Discards message
+    void sendShared(const std::shared_ptr<const std::string>& message) override;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_NULL_H
@@ -3,42 +3,110 @@
 ///
 
 #include "Point.h"
+#include "CoarseClock.h"
+#include "TimestampFormatter.h"
 
-#include <iostream>
+#include <algorithm>
+#include <charconv>
 #include <chrono>
 #include <memory>
-#include <sstream>
 
 namespace influxdb
 {
 
-template<class... Ts> struct overloaded : Ts... { using Ts::operator()...; };
-template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
-
-Point::Point(const std::string& measurement) :
-  mMeasurement(measurement), mTimestamp(Point::getCurrentTimestamp())
+Point::Point(const std::string& measurement, TimestampSource source) :
+  mMeasurement(measurement), mHasTimestamp(source != TimestampSource::Server)
 {
-  mValue = {};
+  if (source == TimestampSource::System) {
+    mTimestamp = Point::getCurrentTimestamp();
+  } else if (source == TimestampSource::Coarse) {
+    mTimestamp = CoarseClock::now();
+  }
   mTags = {};
   mFields = {};
 }
 
-Point&& Point::addField(std::string_view name, std::variant<int, long long int, std::string, double> value)
+void Point::beginField(std::string_view name)
+{
+  if (!mFields.empty()) mFields += ',';
+  mFields += name;
+  mFields += '=';
+}
+
+template<typename T>
+Point&& Point::addIntegerField(std::string_view name, T value, char suffix)
+{
+  beginField(name);
+  char buffer[24];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  mFields.append(buffer, result.ptr - buffer);
+  mFields += suffix;
+  return std::move(*this);
+}
+
+Point&& Point::addField(std::string_view name, bool value)
+{
+  beginField(name);
+  mFields += value ? "true" : "false";
+  return std::move(*this);
+}
+
+Point&& Point::addField(std::string_view name, int value)
+{
+  return addIntegerField(name, value, 'i');
+}
+
+Point&& Point::addField(std::string_view name, long int value)
 {
-  std::stringstream convert;
-  if (!mFields.empty()) convert << ",";
+  return addIntegerField(name, value, 'i');
+}
+
+Point&& Point::addField(std::string_view name, long long int value)
+{
+  return addIntegerField(name, value, 'i');
+}
 
-  convert << name << "=";
-  std::visit(overloaded {
-    [&convert](int value) { convert << value << 'i'; },
-    [&convert](long long int value) { convert << value << 'i'; },
-    [&convert](double value) { convert << value; },
-    [&convert](const std::string& value) { convert << '"' << value << '"'; },
-    }, value);
-  mFields += convert.str();
+Point&& Point::addField(std::string_view name, unsigned int value)
+{
+  return addIntegerField(name, value, 'u');
+}
+
+Point&& Point::addField(std::string_view name, unsigned long int value)
+{
+  return addIntegerField(name, value, 'u');
+}
+
+Point&& Point::addField(std::string_view name, unsigned long long int value)
+{
+  return addIntegerField(name, value, 'u');
+}
+
+Point&& Point::addField(std::string_view name, double value)
+{
+  beginField(name);
+  char buffer[32];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  mFields.append(buffer, result.ptr - buffer);
   return std::move(*this);
 }
 
+Point&& Point::addField(std::string_view name, std::string_view value)
+{
+  beginField(name);
+  mFields += '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') mFields += '\\';
+    mFields += c;
+  }
+  mFields += '"';
+  return std::move(*this);
+}
+
+Point&& Point::addField(std::string_view name, const char* value)
+{
+  return addField(name, std::string_view(value));
+}
+
 Point&& Point::addTag(std::string_view key, std::string_view value)
 {
   mTags += ",";
@@ -51,19 +119,51 @@ Point&& Point::addTag(std::string_view key, std::string_view value)
 Point&& Point::setTimestamp(std::chrono::time_point<std::chrono::system_clock> timestamp)
 {
   mTimestamp = timestamp;
+  mHasTimestamp = true;
   return std::move(*this);
 }
 
+Point&& Point::removeTimestamp()
+{
+  mTimestamp = {};
+  mHasTimestamp = false;
+  return std::move(*this);
+}
+
+bool Point::hasTimestamp() const
+{
+  return mHasTimestamp;
+}
+
 auto Point::getCurrentTimestamp() -> decltype(std::chrono::system_clock::now())
 {
   return std::chrono::system_clock::now();
 }
 
-std::string Point::toLineProtocol() const
+std::string Point::toLineProtocol(Precision precision) const
 {
-  return mMeasurement + mTags + " " + mFields + " " + std::to_string(
-    std::chrono::duration_cast <std::chrono::nanoseconds>(mTimestamp.time_since_epoch()).count()
-  );
+  if (!mHasTimestamp) {
+    return mMeasurement + mTags + " " + mFields;
+  }
+  return mMeasurement + mTags + " " + mFields + " " + std::to_string(toTicks(mTimestamp, precision));
+}
+
+void Point::appendLineProtocol(std::string& out, TimestampFormatter& formatter, Precision precision) const
+{
+  out += mMeasurement;
+  out += mTags;
+  out += ' ';
+  out += mFields;
+  if (mHasTimestamp) {
+    out += ' ';
+    formatter.append(out, toTicks(mTimestamp, precision));
+  }
+  out += '\n';
+}
+
+std::size_t Point::size() const
+{
+  return mMeasurement.size() + mTags.size() + mFields.size() + 22;
 }
 
 std::string Point::getName() const
@@ -71,6 +171,32 @@ std::string Point::getName() const
   return mMeasurement;
 }
 
+std::string_view Point::getNameView() const
+{
+  return mMeasurement;
+}
+
+std::string_view Point::getTagsView() const
+{
+  return mTags;
+}
+
+bool Point::replaceTag(std::string_view key, std::string_view value)
+{
+  std::size_t position = 0;
+  while (position < mTags.size()) {
+    auto keyBegin = position + 1;
+    auto end = std::min(mTags.find(',', keyBegin), mTags.size());
+    auto separator = mTags.find('=', keyBegin);
+    if (separator < end && std::string_view(mTags).substr(keyBegin, separator - keyBegin) == key) {
+      mTags.replace(separator + 1, end - separator - 1, value);
+      return true;
+    }
+    position = end;
+  }
+  return false;
+}
+
 std::chrono::time_point<std::chrono::system_clock> Point::getTimestamp() const
 {
   return mTimestamp;
@@ -83,7 +209,7 @@ std::string Point::getFields() const
 
 std::string Point::getTags() const
 {
-  return mTags.substr(1, mTags.size());
+  return mTags.empty() ? std::string{} : mTags.substr(1);
 }
 
 } // namespace influxdb
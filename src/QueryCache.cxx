@@ -0,0 +1,323 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "QueryCache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+namespace influxdb
+{
+
+namespace
+{
+
+using Nanoseconds = std::chrono::nanoseconds;
+using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
+
+bool isWord(char c)
+{
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+/// \return position of keyword (case insensitive, outside quotes, whole word) at or after from
+std::size_t findKeyword(std::string_view query, std::string_view keyword, std::size_t from = 0)
+{
+  char quote = 0;
+  for (std::size_t i = 0; i < query.size(); ++i) {
+    char c = query[i];
+    if (quote) {
+      if (c == '\\') {
+        ++i;
+      } else if (c == quote) {
+        quote = 0;
+      }
+      continue;
+    }
+    if (c == '\'' || c == '"') {
+      quote = c;
+      continue;
+    }
+    if (i < from || query.size() - i < keyword.size()) {
+      continue;
+    }
+    if (isWord(keyword.front()) && i > 0 && isWord(query[i - 1])) {
+      continue;
+    }
+    bool match = std::equal(keyword.begin(), keyword.end(), query.begin() + i, [](char left, char right) {
+      return std::tolower(static_cast<unsigned char>(left)) == std::tolower(static_cast<unsigned char>(right));
+    });
+    auto end = i + keyword.size();
+    if (match && (!isWord(keyword.back()) || end == query.size() || !isWord(query[end]))) {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+void skipSpace(std::string_view query, std::size_t& position)
+{
+  while (position < query.size() && query[position] == ' ') ++position;
+}
+
+/// Parses InfluxQL duration literal (eg. 10s, 1m), zero on failure
+Nanoseconds parseDuration(std::string_view query, std::size_t& position)
+{
+  long long value = 0;
+  auto start = position;
+  while (position < query.size() && std::isdigit(static_cast<unsigned char>(query[position]))) {
+    value = value * 10 + (query[position++] - '0');
+  }
+  if (position == start) {
+    return Nanoseconds::zero();
+  }
+  static const std::pair<std::string_view, long long> units[] = {
+    {"ns", 1}, {"u", 1000}, {"\xC2\xB5", 1000}, {"ms", 1000000}, {"s", 1000000000LL},
+    {"m", 60000000000LL}, {"h", 3600000000000LL}, {"d", 86400000000000LL}, {"w", 604800000000000LL}
+  };
+  for (const auto& [unit, multiplier] : units) {
+    auto end = position + unit.size();
+    if (query.substr(position, unit.size()) == unit && (end == query.size() || !isWord(query[end]))) {
+      position = end;
+      return Nanoseconds(value * multiplier);
+    }
+  }
+  return Nanoseconds::zero();
+}
+
+bool startsWithKeyword(std::string_view query, std::string_view keyword)
+{
+  return findKeyword(query.substr(0, keyword.size() + 1), keyword) == 0;
+}
+
+/// Only reads without side effects are cached
+bool isCacheable(std::string_view query)
+{
+  return (startsWithKeyword(query, "SELECT") || startsWithKeyword(query, "SHOW"))
+    && findKeyword(query, "INTO") == std::string_view::npos
+    && findKeyword(query, ";") == std::string_view::npos;
+}
+
+/// \return key identifying series of the point
+std::string seriesKey(const Point& point)
+{
+  return point.getName() + '\0' + point.getTags();
+}
+
+/// \return start of the earliest of series' last buckets, every later bucket may still change
+TimePoint trailingBuckets(const std::vector<Point>& points)
+{
+  std::unordered_map<std::string, TimePoint> last;
+  for (const auto& point : points) {
+    auto& timestamp = last[seriesKey(point)];
+    timestamp = std::max(timestamp, point.getTimestamp());
+  }
+  auto from = TimePoint::max();
+  for (const auto& series : last) {
+    from = std::min(from, series.second);
+  }
+  return from;
+}
+
+} // namespace
+
+QueryCache::QueryCache(std::chrono::milliseconds ttl, bool incremental, std::size_t capacity) :
+  mTtl(ttl), mIncremental(incremental), mCapacity(capacity)
+{
+}
+
+std::string QueryCache::Normalize(std::string_view query)
+{
+  std::string normalized;
+  normalized.reserve(query.size());
+  char quote = 0;
+  for (std::size_t i = 0; i < query.size(); ++i) {
+    char c = query[i];
+    if (quote) {
+      normalized += c;
+      if (c == '\\' && i + 1 < query.size()) {
+        normalized += query[++i];
+      } else if (c == quote) {
+        quote = 0;
+      }
+      continue;
+    }
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      if (!normalized.empty() && normalized.back() != ' ') normalized += ' ';
+      continue;
+    }
+    if (c == '\'' || c == '"') {
+      quote = c;
+    }
+    normalized += c;
+  }
+  while (!normalized.empty() && (normalized.back() == ' ' || normalized.back() == ';')) {
+    normalized.pop_back();
+  }
+  return normalized;
+}
+
+std::chrono::nanoseconds QueryCache::BucketInterval(std::string_view query)
+{
+  if (!startsWithKeyword(query, "SELECT") || !isCacheable(query)) {
+    return Nanoseconds::zero();
+  }
+  // limits and ordering make buckets depend on each other
+  for (auto keyword : {"LIMIT", "OFFSET", "SLIMIT", "SOFFSET", "ORDER"}) {
+    if (findKeyword(query, keyword) != std::string_view::npos) {
+      return Nanoseconds::zero();
+    }
+  }
+  auto group = findKeyword(query, "GROUP BY");
+  if (group == std::string_view::npos) {
+    return Nanoseconds::zero();
+  }
+  auto position = findKeyword(query, "time", group);
+  if (position == std::string_view::npos) {
+    return Nanoseconds::zero();
+  }
+  position += 4;
+  skipSpace(query, position);
+  if (position == query.size() || query[position++] != '(') {
+    return Nanoseconds::zero();
+  }
+  skipSpace(query, position);
+  auto interval = parseDuration(query, position);
+  skipSpace(query, position);
+  // time(interval, offset) buckets are not aligned to epoch
+  if (position == query.size() || query[position] != ')') {
+    return Nanoseconds::zero();
+  }
+  return interval;
+}
+
+std::chrono::nanoseconds QueryCache::Window(std::string_view query)
+{
+  auto where = findKeyword(query, "WHERE");
+  if (where == std::string_view::npos) {
+    return Nanoseconds::zero();
+  }
+  for (auto position = findKeyword(query, "time", where); position != std::string_view::npos;
+       position = findKeyword(query, "time", position + 1)) {
+    auto cursor = position + 4;
+    skipSpace(query, cursor);
+    if (cursor == query.size() || query[cursor++] != '>') continue;
+    if (cursor < query.size() && query[cursor] == '=') ++cursor;
+    skipSpace(query, cursor);
+    if (findKeyword(query, "now()", cursor) != cursor) continue;
+    cursor += 5;
+    skipSpace(query, cursor);
+    if (cursor == query.size() || query[cursor++] != '-') continue;
+    skipSpace(query, cursor);
+    auto window = parseDuration(query, cursor);
+    if (window.count() > 0) {
+      return window;
+    }
+  }
+  return Nanoseconds::zero();
+}
+
+std::string QueryCache::Restrict(std::string_view query, std::chrono::time_point<std::chrono::system_clock> from)
+{
+  auto condition = "time >= " + std::to_string(std::chrono::duration_cast<Nanoseconds>(from.time_since_epoch()).count());
+  auto group = findKeyword(query, "GROUP BY");
+  auto where = findKeyword(query, "WHERE");
+  std::string restricted(query.substr(0, where == std::string_view::npos ? group : where));
+  if (where == std::string_view::npos) {
+    restricted += "WHERE " + condition + " ";
+  } else {
+    auto existing = query.substr(where + 5, group - where - 5);
+    while (!existing.empty() && existing.front() == ' ') existing.remove_prefix(1);
+    while (!existing.empty() && existing.back() == ' ') existing.remove_suffix(1);
+    restricted += "WHERE " + condition + " AND (" + std::string(existing) + ") ";
+  }
+  restricted += query.substr(group);
+  return restricted;
+}
+
+void QueryCache::Merge(std::vector<Point>& cached, std::vector<Point>&& fresh,
+  std::chrono::time_point<std::chrono::system_clock> from, std::chrono::nanoseconds interval,
+  std::chrono::nanoseconds window)
+{
+  // buckets that slid out of "time > now() - window" are dropped
+  auto start = TimePoint::min();
+  if (window.count() > 0) {
+    auto begin = std::chrono::duration_cast<Nanoseconds>((std::chrono::system_clock::now() - window).time_since_epoch());
+    start = TimePoint(std::chrono::duration_cast<TimePoint::duration>(begin - begin % interval));
+  }
+  cached.erase(std::remove_if(cached.begin(), cached.end(), [&](const Point& point) {
+    return point.getTimestamp() >= from || point.getTimestamp() < start;
+  }), cached.end());
+  std::move(fresh.begin(), fresh.end(), std::back_inserter(cached));
+
+  // keep series in order of first appearance, buckets of each series stay in time order
+  std::unordered_map<std::string, std::size_t> order;
+  std::vector<std::pair<std::size_t, Point>> indexed;
+  indexed.reserve(cached.size());
+  for (auto& point : cached) {
+    auto index = order.emplace(seriesKey(point), order.size()).first->second;
+    indexed.emplace_back(index, std::move(point));
+  }
+  std::stable_sort(indexed.begin(), indexed.end(), [](const auto& left, const auto& right) {
+    return left.first < right.first;
+  });
+  cached.clear();
+  for (auto& entry : indexed) {
+    cached.push_back(std::move(entry.second));
+  }
+}
+
+std::vector<Point> QueryCache::get(const std::string& query, const Fetch& fetch)
+{
+  auto key = Normalize(query);
+  if (!isCacheable(key)) {
+    return fetch(query);
+  }
+  auto now = std::chrono::steady_clock::now();
+  std::vector<Point> cached;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto entry = mEntries.find(key);
+    if (entry != mEntries.end()) {
+      if (now - entry->second.fetched < mTtl) {
+        return entry->second.points;
+      }
+      if (mIncremental) {
+        cached = entry->second.points;
+      }
+    }
+  }
+
+  auto interval = mIncremental ? BucketInterval(key) : Nanoseconds::zero();
+  if (interval.count() > 0 && !cached.empty()) {
+    auto from = trailingBuckets(cached);
+    Merge(cached, fetch(Restrict(key, from)), from, interval, Window(key));
+    store(key, cached, now);
+    return cached;
+  }
+  auto points = fetch(query);
+  store(key, points, now);
+  return points;
+}
+
+void QueryCache::store(const std::string& key, std::vector<Point> points, std::chrono::steady_clock::time_point fetched)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mEntries.empty() && mEntries.size() >= mCapacity && mEntries.find(key) == mEntries.end()) {
+    auto oldest = std::min_element(mEntries.begin(), mEntries.end(), [](const auto& left, const auto& right) {
+      return left.second.fetched < right.second.fetched;
+    });
+    mEntries.erase(oldest);
+  }
+  mEntries[key] = Entry{std::move(points), fetched};
+}
+
+void QueryCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mEntries.clear();
+}
+
+} // namespace influxdb
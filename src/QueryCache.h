@@ -0,0 +1,89 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_QUERYCACHE_H
+#define INFLUXDATA_QUERYCACHE_H
+
+#include "Point.h"
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace influxdb
+{
+
+/// \brief Client-side cache of query results keyed on normalized query text
+/// Results are reused until TTL expires. In incremental mode expired results of queries grouped by time()
+/// are refreshed from the last cached bucket on: older buckets are complete and kept, trailing ones are
+/// fetched again and merged. Statements modifying data (SELECT INTO, DROP, ...) are never cached.
+class QueryCache
+{
+  public:
+    /// Runs query on the server
+    using Fetch = std::function<std::vector<Point>(const std::string& query)>;
+
+    /// Constructor
+    /// \param ttl          how long results are reused
+    /// \param incremental  whether expired time() grouped results are refreshed partially
+    /// \param capacity     maximum number of cached queries
+    QueryCache(std::chrono::milliseconds ttl, bool incremental, std::size_t capacity = 1024);
+
+    /// \return cached results of the query, fetching them when missing or expired
+    std::vector<Point> get(const std::string& query, const Fetch& fetch);
+
+    /// Drops all cached results
+    void clear();
+
+    /// \return query with whitespace outside quotes collapsed and trailing ';' removed
+    static std::string Normalize(std::string_view query);
+
+    /// \return GROUP BY time() interval of normalized query, zero when it cannot be refreshed incrementally
+    static std::chrono::nanoseconds BucketInterval(std::string_view query);
+
+    /// \return length of "time > now() - <window>" condition of normalized query, zero if none
+    static std::chrono::nanoseconds Window(std::string_view query);
+
+    /// \return normalized query restricted to buckets starting at or after given time
+    static std::string Restrict(std::string_view query, std::chrono::time_point<std::chrono::system_clock> from);
+
+  private:
+    /// Cached result
+    struct Entry
+    {
+      std::vector<Point> points;
+      std::chrono::steady_clock::time_point fetched;
+    };
+
+    /// Merges refreshed trailing buckets into cached points
+    static void Merge(std::vector<Point>& cached, std::vector<Point>&& fresh,
+      std::chrono::time_point<std::chrono::system_clock> from, std::chrono::nanoseconds interval,
+      std::chrono::nanoseconds window);
+
+    /// Stores result, evicting the oldest entry when full
+    void store(const std::string& key, std::vector<Point> points, std::chrono::steady_clock::time_point fetched);
+
+    /// Results by normalized query
+    std::unordered_map<std::string, Entry> mEntries;
+
+    /// Guards entries
+    std::mutex mMutex;
+
+    /// Time to live
+    std::chrono::milliseconds mTtl;
+
+    /// Whether time buckets are refreshed incrementally
+    bool mIncremental;
+
+    /// Maximum number of entries
+    std::size_t mCapacity;
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_QUERYCACHE_H
@@ -0,0 +1,121 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "Replicated.h"
+#include "InfluxDBException.h"
+
+namespace influxdb
+{
+namespace transports
+{
+
+Replicated::Replicated(std::vector<std::unique_ptr<Transport>>&& destinations, std::size_t queueSize) :
+  mQueueSize(queueSize > 0 ? queueSize : 1)
+{
+  if (destinations.empty()) {
+    throw InfluxDBException("Replicated::Replicated", "No destinations provided");
+  }
+  for (auto& transport : destinations) {
+    auto destination = std::make_unique<Destination>();
+    destination->transport = std::move(transport);
+    destination->thread = std::thread(&Replicated::run, std::ref(*destination));
+    mDestinations.push_back(std::move(destination));
+  }
+}
+
+Replicated::~Replicated()
+{
+  for (auto& destination : mDestinations) {
+    {
+      std::lock_guard<std::mutex> lock(destination->mutex);
+      destination->stop = true;
+    }
+    destination->condition.notify_one();
+  }
+  for (auto& destination : mDestinations) {
+    destination->thread.join();
+  }
+}
+
+void Replicated::run(Destination& destination)
+{
+  std::unique_lock<std::mutex> lock(destination.mutex);
+  for (;;) {
+    destination.condition.wait(lock, [&destination] { return destination.stop || !destination.queue.empty(); });
+    if (destination.queue.empty()) {
+      return;
+    }
+    auto message = std::move(destination.queue.front());
+    destination.queue.pop_front();
+    lock.unlock();
+    try {
+      destination.transport->sendShared(message);
+    } catch (...) {
+      lock.lock();
+      destination.failed++;
+      continue;
+    }
+    lock.lock();
+  }
+}
+
+void Replicated::send(std::string&& message)
+{
+  sendShared(std::make_shared<const std::string>(std::move(message)));
+}
+
+void Replicated::sendShared(const std::shared_ptr<const std::string>& message)
+{
+  for (auto& destination : mDestinations) {
+    {
+      std::lock_guard<std::mutex> lock(destination->mutex);
+      if (destination->queue.size() >= mQueueSize) {
+        destination->queue.pop_front();
+        destination->dropped++;
+      }
+      destination->queue.push_back(message);
+    }
+    destination->condition.notify_one();
+  }
+}
+
+void Replicated::setPrecision(Precision precision)
+{
+  for (auto& destination : mDestinations) {
+    destination->transport->setPrecision(precision);
+  }
+}
+
+std::size_t Replicated::dropped(std::size_t destination) const
+{
+  std::lock_guard<std::mutex> lock(mDestinations.at(destination)->mutex);
+  return mDestinations[destination]->dropped;
+}
+
+std::size_t Replicated::failed(std::size_t destination) const
+{
+  std::lock_guard<std::mutex> lock(mDestinations.at(destination)->mutex);
+  return mDestinations[destination]->failed;
+}
+
+std::size_t Replicated::dropped() const
+{
+  std::size_t dropped = 0;
+  for (std::size_t i = 0; i < mDestinations.size(); i++) {
+    dropped += this->dropped(i);
+  }
+  return dropped;
+}
+
+std::size_t Replicated::failed() const
+{
+  std::size_t failed = 0;
+  for (std::size_t i = 0; i < mDestinations.size(); i++) {
+    failed += this->failed(i);
+  }
+  return failed;
+}
+
+} // namespace transports
+} // namespace influxdb
@@ -0,0 +1,86 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_REPLICATED_H
+#define INFLUXDATA_TRANSPORTS_REPLICATED_H
+
+#include "Transport.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief Composite transport delivering every message to all destinations
+/// Each destination has its own bounded queue and sender thread, so a slow replica does not stall the others.
+/// A message is stored once and shared (refcounted) by all the queues.
+class Replicated : public Transport
+{
+  public:
+    /// Constructor
+    /// \param destinations   replicas
+    /// \param queueSize      maximum number of messages queued per destination, the oldest is dropped when full
+    /// \throw InfluxDBException	if no destination provided
+    Replicated(std::vector<std::unique_ptr<Transport>>&& destinations, std::size_t queueSize = 1024);
+
+    /// Sends queued messages and stops sender threads
+    ~Replicated();
+
+    /// Enqueues message for all destinations, does not block on sending
+    void send(std::string&& message) override;
+
+    /// Enqueues shared message for all destinations
+    void sendShared(const std::shared_ptr<const std::string>& message) override;
+
+    /// Forwards precision to all destinations
+    void setPrecision(Precision precision) override;
+
+    /// \return number of messages dropped due to full queue of given destination
+    std::size_t dropped(std::size_t destination) const;
+
+    /// \return number of messages given destination failed to send
+    std::size_t failed(std::size_t destination) const;
+
+    /// \return number of messages dropped by all destinations
+    std::size_t dropped() const override;
+
+    /// \return number of messages all destinations failed to send
+    std::size_t failed() const override;
+
+  private:
+    /// Destination with its queue and sender thread
+    struct Destination
+    {
+      std::unique_ptr<Transport> transport;
+      std::deque<std::shared_ptr<const std::string>> queue;
+      mutable std::mutex mutex;
+      std::condition_variable condition;
+      std::thread thread;
+      std::size_t dropped = 0;
+      std::size_t failed = 0;
+      bool stop = false;
+    };
+
+    /// Sender thread loop
+    static void run(Destination& destination);
+
+    /// Replicas
+    std::vector<std::unique_ptr<Destination>> mDestinations;
+
+    /// Maximum queue length
+    std::size_t mQueueSize;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_REPLICATED_H
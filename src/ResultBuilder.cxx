@@ -0,0 +1,215 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "ResultBuilder.h"
+#include "InfluxDBException.h"
+#include "TimestampParser.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace influxdb
+{
+
+ResultBuilder::ResultBuilder(Precision precision, const TagKeys* tagKeys) :
+  mPrecision(precision), mColumn(0), mHasTags(false), mTagKeys(tagKeys), mLookedUp(false)
+{
+}
+
+void ResultBuilder::statement(int id)
+{
+  mResults.push_back({id, {}, {}});
+}
+
+void ResultBuilder::error(std::string_view message)
+{
+  throw InfluxDBException("InfluxDB::query", std::string(message));
+}
+
+void ResultBuilder::statementError(std::string_view message)
+{
+  if (mResults.empty()) {
+    statement(0);
+  }
+  mResults.back().error = message;
+}
+
+void ResultBuilder::series()
+{
+  if (mResults.empty()) {
+    statement(0);
+  }
+  mName.clear();
+  mTags.clear();
+  mColumns.clear();
+  mHasTags = false;
+  mSeriesKeys.reset();
+  mLookedUp = false;
+}
+
+void ResultBuilder::name(std::string_view name)
+{
+  mName = name;
+}
+
+void ResultBuilder::tag(std::string_view key, std::string_view value)
+{
+  mTags.emplace_back(key, value);
+  mHasTags = true;
+}
+
+void ResultBuilder::column(std::string_view name)
+{
+  mColumns.emplace_back(name);
+}
+
+void ResultBuilder::row()
+{
+  auto& points = mResults.back().points;
+  points.emplace_back(mName, TimestampSource::Server);
+  for (const auto& tag : mTags) {
+    points.back().addTag(tag.first, tag.second);
+  }
+  mColumn = 0;
+}
+
+const std::string* ResultBuilder::nextColumn()
+{
+  if (mResults.empty() || mResults.back().points.empty() || mColumn >= mColumns.size()) {
+    return nullptr;
+  }
+  return &mColumns[mColumn++];
+}
+
+void ResultBuilder::value(std::nullptr_t)
+{
+  nextColumn();
+}
+
+void ResultBuilder::value(bool value)
+{
+  if (auto column = nextColumn()) {
+    mResults.back().points.back().addField(*column, value);
+  }
+}
+
+void ResultBuilder::value(long long int value)
+{
+  if (auto column = nextColumn()) {
+    auto& point = mResults.back().points.back();
+    if (*column == "time") {
+      point.setTimestamp(fromTicks(value, mPrecision));
+    } else {
+      point.addField(*column, value);
+    }
+  }
+}
+
+void ResultBuilder::number(long long int value)
+{
+  if (auto column = nextColumn()) {
+    auto& point = mResults.back().points.back();
+    if (*column == "time") {
+      point.setTimestamp(fromTicks(value, mPrecision));
+    } else {
+      point.addField(*column, static_cast<double>(value));
+    }
+  }
+}
+
+void ResultBuilder::value(unsigned long long int value)
+{
+  if (auto column = nextColumn()) {
+    mResults.back().points.back().addField(*column, value);
+  }
+}
+
+void ResultBuilder::value(double value)
+{
+  if (auto column = nextColumn()) {
+    mResults.back().points.back().addField(*column, value);
+  }
+}
+
+void ResultBuilder::value(std::string_view value)
+{
+  if (auto column = nextColumn()) {
+    auto& point = mResults.back().points.back();
+    if (*column == "time") {
+      std::chrono::time_point<std::chrono::system_clock> timestamp;
+      if (parseRfc3339(value, timestamp) || parseEpoch(value, mPrecision, timestamp)) {
+        point.setTimestamp(timestamp);
+      }
+    } else if (isTag(*column)) {
+      point.addTag(*column, value);
+    } else {
+      point.addField(*column, value);
+    }
+  }
+}
+
+bool ResultBuilder::isTag(const std::string& column)
+{
+  if (mHasTags) {
+    return false;
+  }
+  if (!mLookedUp) {
+    mLookedUp = true;
+    mSeriesKeys = mTagKeys ? mTagKeys->find(mName) : nullptr;
+    if (!mSeriesKeys) {
+      mUnresolved.insert(mName);
+    }
+  }
+  return mSeriesKeys && mSeriesKeys->count(column) > 0;
+}
+
+void ResultBuilder::timestamp(std::chrono::time_point<std::chrono::system_clock> timestamp)
+{
+  if (nextColumn()) {
+    mResults.back().points.back().setTimestamp(timestamp);
+  }
+}
+
+std::vector<std::vector<Point>> ResultBuilder::results()
+{
+  std::stable_sort(mResults.begin(), mResults.end(), [](const auto& left, const auto& right) {
+    return left.id < right.id;
+  });
+  std::vector<std::vector<Point>> results;
+  results.reserve(mResults.size());
+  for (auto& result : mResults) {
+    if (!result.error.empty()) {
+      auto error = std::move(result.error);
+      mResults.clear();
+      throw InfluxDBException("InfluxDB::query", error);
+    }
+    results.push_back(std::move(result.points));
+  }
+  mResults.clear();
+  return results;
+}
+
+const std::set<std::string>& ResultBuilder::unresolved() const
+{
+  return mUnresolved;
+}
+
+std::vector<StatementResult> ResultBuilder::results(std::size_t statements)
+{
+  std::vector<StatementResult> results(statements);
+  for (auto& result : mResults) {
+    if (result.id < 0 || static_cast<std::size_t>(result.id) >= statements) {
+      throw InfluxDBException("InfluxDB::query", "Unexpected statement_id: " + std::to_string(result.id));
+    }
+    auto& statement = results[result.id];
+    std::move(result.points.begin(), result.points.end(), std::back_inserter(statement.points));
+    if (!result.error.empty()) {
+      statement.error = std::move(result.error);
+    }
+  }
+  mResults.clear();
+  return results;
+}
+
+} // namespace influxdb
@@ -0,0 +1,136 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_RESULTBUILDER_H
+#define INFLUXDATA_RESULTBUILDER_H
+
+#include "InfluxDB.h"
+#include "Point.h"
+#include "TagKeys.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace influxdb
+{
+
+/// \brief Builds points from query response events emitted by a decoder (JSON, MessagePack)
+/// Values keep their wire type: integers, floats, booleans and strings are added as fields of matching type.
+/// When the series carries tag metadata (GROUP BY) string columns are string fields. Otherwise (plain SELECT)
+/// string columns are tags if listed in the tag keys of the measurement, and string fields when the keys say
+/// otherwise or are not known; measurements with unknown keys are reported by unresolved().
+class ResultBuilder
+{
+  public:
+    /// Constructor
+    /// \param precision   unit of integer timestamps
+    /// \param tagKeys     known tag keys of measurements (optional)
+    ResultBuilder(Precision precision, const TagKeys* tagKeys = nullptr);
+
+    /// Starts statement result
+    void statement(int id);
+
+    /// Reports error of the whole request
+    /// \throw InfluxDBException
+    void error(std::string_view message);
+
+    /// Records error of the current statement
+    void statementError(std::string_view message);
+
+    /// Starts series
+    void series();
+
+    /// Sets series (measurement) name
+    void name(std::string_view name);
+
+    /// Adds series tag
+    void tag(std::string_view key, std::string_view value);
+
+    /// Adds series column
+    void column(std::string_view name);
+
+    /// Starts row
+    void row();
+
+    /// Adds typed cell value of current row
+    void value(std::nullptr_t);
+    void value(bool value);
+    void value(long long int value);
+    void value(unsigned long long int value);
+    void value(double value);
+    void value(std::string_view value);
+
+    /// Adds untyped number written without fraction (JSON): timestamp in time column, float field otherwise
+    void number(long long int value);
+
+    /// Sets timestamp of current row (decoders with native time type)
+    void timestamp(std::chrono::time_point<std::chrono::system_clock> timestamp);
+
+    /// \return points of each statement ordered by statement id
+    /// \throw InfluxDBException if a statement failed
+    std::vector<std::vector<Point>> results();
+
+    /// \return measurements with string columns but no tag metadata whose tag keys are not known
+    const std::set<std::string>& unresolved() const;
+
+    /// \return points and error of each statement indexed by statement id (statements without results stay empty)
+    /// \throw InfluxDBException if statement id out of range
+    std::vector<StatementResult> results(std::size_t statements);
+
+  private:
+    /// \return current column name, moves to the next one
+    const std::string* nextColumn();
+
+    /// \return whether string column of the current series is a tag
+    bool isTag(const std::string& column);
+
+    /// Timestamp unit
+    Precision mPrecision;
+
+    /// Result of a statement
+    struct Statement
+    {
+      int id;
+      std::vector<Point> points;
+      std::string error;
+    };
+
+    /// Results in order of arrival
+    std::vector<Statement> mResults;
+
+    /// Current series name
+    std::string mName;
+
+    /// Current series tags
+    std::vector<std::pair<std::string, std::string>> mTags;
+
+    /// Current series columns
+    std::vector<std::string> mColumns;
+
+    /// Column of the next value
+    std::size_t mColumn;
+
+    /// Whether series tags metadata present
+    bool mHasTags;
+
+    /// Known tag keys (null when not available)
+    const TagKeys* mTagKeys;
+
+    /// Tag keys of the current series measurement, looked up on first string value
+    std::shared_ptr<const TagKeys::Keys> mSeriesKeys;
+
+    /// Whether mSeriesKeys was looked up for the current series
+    bool mLookedUp;
+
+    /// Measurements whose tag keys were needed but not known
+    std::set<std::string> mUnresolved;
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_RESULTBUILDER_H
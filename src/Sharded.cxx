@@ -0,0 +1,148 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "Sharded.h"
+#include "InfluxDBException.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+namespace influxdb
+{
+namespace transports
+{
+
+namespace
+{
+/// FNV-1a followed by a 64-bit finalizer to spread similar keys on the ring
+std::uint64_t hash(std::string_view data)
+{
+  std::uint64_t value = 14695981039346656037ULL;
+  for (unsigned char c : data) {
+    value ^= c;
+    value *= 1099511628211ULL;
+  }
+  value ^= value >> 33;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33;
+  return value;
+}
+} // namespace
+
+Sharded::Sharded(std::vector<std::pair<std::string, std::unique_ptr<Transport>>>&& shards, unsigned int virtualNodes)
+{
+  if (shards.empty()) {
+    throw InfluxDBException("Sharded::Sharded", "No shards provided");
+  }
+  for (auto& shard : shards) {
+    for (unsigned int node = 0; node < virtualNodes; node++) {
+      mRing.emplace_back(hash(shard.first + "#" + std::to_string(node)), mShards.size());
+    }
+    mShards.push_back(std::move(shard.second));
+  }
+  std::sort(mRing.begin(), mRing.end());
+}
+
+std::string_view Sharded::SeriesKey(std::string_view line)
+{
+  for (std::size_t i = 0; i < line.size(); i++) {
+    if (line[i] == '\\') {
+      i++;
+    } else if (line[i] == ' ') {
+      return line.substr(0, i);
+    }
+  }
+  return line;
+}
+
+std::size_t Sharded::dropped() const
+{
+  std::size_t dropped = 0;
+  for (const auto& shard : mShards) {
+    dropped += shard->dropped();
+  }
+  return dropped;
+}
+
+std::size_t Sharded::failed() const
+{
+  std::size_t failed = 0;
+  for (const auto& shard : mShards) {
+    failed += shard->failed();
+  }
+  return failed;
+}
+
+std::size_t Sharded::route(std::string_view seriesKey) const
+{
+  auto point = std::lower_bound(mRing.begin(), mRing.end(), std::make_pair(hash(seriesKey), std::size_t{0}));
+  return (point == mRing.end()) ? mRing.front().second : point->second;
+}
+
+void Sharded::setPrecision(Precision precision)
+{
+  for (auto& shard : mShards) {
+    shard->setPrecision(precision);
+  }
+}
+
+void Sharded::send(std::string&& message)
+{
+  if (mShards.size() == 1) {
+    mShards.front()->send(std::move(message));
+    return;
+  }
+
+  std::vector<std::string> batches(mShards.size());
+  std::string_view remaining(message);
+  while (!remaining.empty()) {
+    auto end = remaining.find('\n');
+    auto line = remaining.substr(0, end);
+    remaining.remove_prefix(end == std::string_view::npos ? remaining.size() : end + 1);
+    if (line.empty()) continue;
+    auto& batch = batches[route(SeriesKey(line))];
+    batch.append(line.data(), line.size());
+    batch += '\n';
+  }
+
+  // shards transferring concurrently (eg. HTTP) do so through sendAsync, the others send in turn
+  struct Completion
+  {
+    std::mutex mutex;
+    std::condition_variable done;
+    std::size_t pending;
+    std::exception_ptr error;
+  };
+  auto completion = std::make_shared<Completion>();
+  completion->pending = std::count_if(batches.begin(), batches.end(), [](const std::string& batch) {
+    return !batch.empty();
+  });
+  SendHandler complete = [completion](std::exception_ptr error) {
+    std::lock_guard<std::mutex> lock(completion->mutex);
+    if (error && !completion->error) completion->error = error;
+    if (--completion->pending == 0) completion->done.notify_one();
+  };
+  for (std::size_t shard = 0; shard < mShards.size(); shard++) {
+    if (batches[shard].empty()) continue;
+    try {
+      mShards[shard]->sendAsync(std::move(batches[shard]), complete);
+    } catch (...) {
+      complete(std::current_exception());
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(completion->mutex);
+  completion->done.wait(lock, [&completion] { return completion->pending == 0; });
+  auto error = completion->error;
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace transports
+} // namespace influxdb
@@ -0,0 +1,65 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_SHARDED_H
+#define INFLUXDATA_TRANSPORTS_SHARDED_H
+
+#include "Transport.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief Composite transport distributing lines across shards by consistent hash of series key
+class Sharded : public Transport
+{
+  public:
+    /// Constructor
+    /// \param shards         shard name (used as its identity on the hash ring) and its transport
+    /// \param virtualNodes   number of points per shard on the hash ring
+    /// \throw InfluxDBException	if no shard provided
+    Sharded(std::vector<std::pair<std::string, std::unique_ptr<Transport>>>&& shards, unsigned int virtualNodes = 128);
+
+    /// Default destructor
+    ~Sharded() = default;
+
+    /// Splits batch per shard and sends shard batches, concurrently through sendAsync of shards supporting it (HTTP)
+    /// \throw InfluxDBException	first error reported by a shard, after all shards finished
+    void send(std::string&& message) override;
+
+    /// Forwards precision to all shards
+    void setPrecision(Precision precision) override;
+
+    /// \return number of messages dropped by all shards
+    std::size_t dropped() const override;
+
+    /// \return number of messages all shards failed to send in background
+    std::size_t failed() const override;
+
+    /// \return shard index owning given series
+    std::size_t route(std::string_view seriesKey) const;
+
+    /// \return series key (measurement and tags) of a line
+    static std::string_view SeriesKey(std::string_view line);
+
+  private:
+    /// Shard transports
+    std::vector<std::unique_ptr<Transport>> mShards;
+
+    /// Hash ring: sorted points and owning shard index
+    std::vector<std::pair<std::uint64_t, std::size_t>> mRing;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_SHARDED_H
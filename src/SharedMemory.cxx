@@ -0,0 +1,218 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "SharedMemory.h"
+#include "InfluxDBException.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace influxdb
+{
+namespace transports
+{
+
+struct SharedMemory::Header
+{
+  /// Set by the creator once the ring is initialized
+  std::atomic<std::uint64_t> magic;
+
+  /// Ring data size
+  std::uint64_t capacity;
+
+  /// Position up to which producers claimed space
+  alignas(64) std::atomic<std::uint64_t> reserved;
+
+  /// Position up to which consumer released space
+  alignas(64) std::atomic<std::uint64_t> consumed;
+
+  /// Messages dropped as the ring was full
+  alignas(64) std::atomic<std::uint64_t> dropped;
+};
+
+namespace
+{
+
+constexpr std::uint64_t Magic = 0x696e666c75787368; // "influxsh"
+
+/// Ring data starts after the header
+constexpr std::size_t HeaderSize = 256;
+static_assert(sizeof(SharedMemory::Header) <= HeaderSize, "Header exceeds reserved space");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Lock-free 64 bit atomics required");
+
+/// Record kinds stored in the low bits of record header, the rest is length; zero means not committed
+constexpr std::uint64_t Message = 1;
+constexpr std::uint64_t Padding = 2;
+
+/// \return bytes taken by message record: 8 bytes header and payload aligned to 8 bytes
+std::uint64_t recordSize(std::uint64_t length)
+{
+  return (8 + length + 7) & ~std::uint64_t{7};
+}
+
+std::string objectName(const std::string& name)
+{
+  return "/" + name;
+}
+
+} // namespace
+
+SharedMemory::SharedMemory(const std::string& name, std::size_t capacity)
+{
+  auto path = objectName(name);
+  int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  bool created = fd >= 0;
+  if (!created) {
+    if (errno != EEXIST) {
+      throw InfluxDBException("SharedMemory", "Cannot create " + path + ": " + std::strerror(errno));
+    }
+    fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+      throw InfluxDBException("SharedMemory", "Cannot open " + path + ": " + std::strerror(errno));
+    }
+  }
+
+  struct stat status{};
+  if (created) {
+    mCapacity = 4096;
+    while (mCapacity < capacity) mCapacity <<= 1;
+    if (ftruncate(fd, HeaderSize + mCapacity) != 0) {
+      close(fd);
+      throw InfluxDBException("SharedMemory", "Cannot resize " + path + ": " + std::strerror(errno));
+    }
+    status.st_size = HeaderSize + mCapacity;
+  } else {
+    // creator may still be sizing the object
+    for (int attempt = 0; attempt < 1000 && fstat(fd, &status) == 0 && status.st_size == 0; attempt++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (static_cast<std::size_t>(status.st_size) <= HeaderSize) {
+      close(fd);
+      throw InfluxDBException("SharedMemory", "Invalid size of " + path);
+    }
+  }
+
+  mMappedSize = status.st_size;
+  void* address = mmap(nullptr, mMappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    throw InfluxDBException("SharedMemory", "Cannot map " + path + ": " + std::strerror(errno));
+  }
+  mHeader = static_cast<Header*>(address);
+  mData = static_cast<char*>(address) + HeaderSize;
+
+  if (created) {
+    mHeader->capacity = mCapacity;
+    mHeader->magic.store(Magic, std::memory_order_release);
+    return;
+  }
+  for (int attempt = 0; attempt < 1000 && mHeader->magic.load(std::memory_order_acquire) != Magic; attempt++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  mCapacity = mHeader->capacity;
+  if (mHeader->magic.load(std::memory_order_acquire) != Magic || HeaderSize + mCapacity != mMappedSize) {
+    munmap(address, mMappedSize);
+    throw InfluxDBException("SharedMemory", path + " is not a ring buffer");
+  }
+}
+
+SharedMemory::~SharedMemory()
+{
+  munmap(mHeader, mMappedSize);
+}
+
+void SharedMemory::Unlink(const std::string& name)
+{
+  shm_unlink(objectName(name).c_str());
+}
+
+void SharedMemory::send(std::string&& message)
+{
+  auto record = recordSize(message.size());
+  if (record > mCapacity / 2) {
+    mHeader->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  auto position = mHeader->reserved.load(std::memory_order_relaxed);
+  std::uint64_t padding;
+  do {
+    // a record never wraps, the rest of the ring is skipped instead
+    auto offset = position & (mCapacity - 1);
+    padding = offset + record > mCapacity ? mCapacity - offset : 0;
+    if (position + padding + record - mHeader->consumed.load(std::memory_order_acquire) > mCapacity) {
+      mHeader->dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  } while (!mHeader->reserved.compare_exchange_weak(position, position + padding + record, std::memory_order_relaxed));
+
+  if (padding > 0) {
+    auto word = reinterpret_cast<std::atomic<std::uint64_t>*>(mData + (position & (mCapacity - 1)));
+    word->store((padding << 2) | Padding, std::memory_order_release);
+    position += padding;
+  }
+  put(position, message);
+}
+
+void SharedMemory::put(std::uint64_t position, const std::string& message)
+{
+  auto offset = position & (mCapacity - 1);
+  std::memcpy(mData + offset + 8, message.data(), message.size());
+  auto word = reinterpret_cast<std::atomic<std::uint64_t>*>(mData + offset);
+  word->store((static_cast<std::uint64_t>(message.size()) << 2) | Message, std::memory_order_release);
+}
+
+std::size_t SharedMemory::drain(std::string& batch, std::size_t maxBytes)
+{
+  auto position = mHeader->consumed.load(std::memory_order_relaxed);
+  auto start = position;
+  auto reserved = mHeader->reserved.load(std::memory_order_acquire);
+  std::size_t messages = 0;
+  while (position != reserved) {
+    auto offset = position & (mCapacity - 1);
+    auto word = reinterpret_cast<std::atomic<std::uint64_t>*>(mData + offset);
+    auto header = word->load(std::memory_order_acquire);
+    if (header == 0) {
+      // claimed but not yet committed
+      break;
+    }
+    auto length = header >> 2;
+    std::uint64_t record = length;
+    if ((header & 3) == Message) {
+      if (messages > 0 && batch.size() + length + 1 > maxBytes) {
+        break;
+      }
+      const char* payload = mData + offset + 8;
+      batch.append(payload, length);
+      if (length == 0 || payload[length - 1] != '\n') {
+        batch += '\n';
+      }
+      record = recordSize(length);
+      messages++;
+    }
+    // producers expect zeroed space, headers of later records may land anywhere in it
+    std::memset(mData + offset + 8, 0, record - 8);
+    word->store(0, std::memory_order_relaxed);
+    position += record;
+  }
+  if (position != start) {
+    mHeader->consumed.store(position, std::memory_order_release);
+  }
+  return messages;
+}
+
+std::size_t SharedMemory::dropped() const
+{
+  return mHeader->dropped.load(std::memory_order_relaxed);
+}
+
+} // namespace transports
+} // namespace influxdb
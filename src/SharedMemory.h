@@ -0,0 +1,72 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_SHAREDMEMORY_H
+#define INFLUXDATA_TRANSPORTS_SHAREDMEMORY_H
+
+#include "Transport.h"
+
+#include <cstdint>
+#include <string>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief Lock-free ring buffer in POSIX shared memory, drained by a co-located forwarder (influxdb-forwarder)
+/// Any number of threads and processes may send (multi-producer), one consumer drains.
+/// Sending is a few atomic operations and a memcpy, no system calls; messages that do not fit are dropped.
+/// A producer killed in the middle of send() stalls the consumer at its unfinished message.
+class SharedMemory : public Transport
+{
+  public:
+    /// Opens ring, creates it if it does not exist
+    /// \param name       shared memory object name (without leading '/')
+    /// \param capacity   size of ring data in bytes (rounded up to power of 2); used only when the ring is created
+    /// \throw InfluxDBException	if shared memory cannot be created or mapped
+    SharedMemory(const std::string& name, std::size_t capacity = 16 * 1024 * 1024);
+
+    /// Unmaps shared memory (ring persists until Unlink)
+    ~SharedMemory();
+
+    /// Copies message into the ring, drops it when the ring is full
+    void send(std::string&& message) override;
+
+    /// Appends committed messages (newline terminated) to batch, consumer side
+    /// \param batch      output buffer
+    /// \param maxBytes   stop before batch exceeds the size (at least one message is taken)
+    /// \return number of messages taken
+    std::size_t drain(std::string& batch, std::size_t maxBytes);
+
+    /// \return number of messages dropped by producers as the ring was full
+    std::size_t dropped() const override;
+
+    /// Removes shared memory object
+    static void Unlink(const std::string& name);
+
+    /// Shared memory layout
+    struct Header;
+
+  private:
+    /// Writes message record at ring position, commits it last
+    void put(std::uint64_t position, const std::string& message);
+
+    /// Mapped header
+    Header* mHeader;
+
+    /// Mapped ring data
+    char* mData;
+
+    /// Ring data size
+    std::uint64_t mCapacity;
+
+    /// Size of mapping
+    std::size_t mMappedSize;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_SHAREDMEMORY_H
@@ -0,0 +1,74 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "Stream.h"
+#include "InfluxDBException.h"
+
+#include <array>
+#include <sys/socket.h>
+
+namespace influxdb
+{
+namespace transports
+{
+
+Stream::Stream(std::size_t bufferSize) :
+  mSocket(mIoService), mBufferSize(bufferSize)
+{
+}
+
+void Stream::send(std::string&& message)
+{
+  write(message);
+}
+
+void Stream::sendShared(const std::shared_ptr<const std::string>& message)
+{
+  write(*message);
+}
+
+void Stream::configure()
+{
+  if (mBufferSize > 0) {
+    mSocket.set_option(boost::asio::socket_base::send_buffer_size(static_cast<int>(mBufferSize)));
+  }
+}
+
+bool Stream::closedByPeer()
+{
+  char byte;
+  return ::recv(mSocket.native_handle(), &byte, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+}
+
+void Stream::write(const std::string& message)
+{
+  std::array<boost::asio::const_buffer, 2> buffers = {
+    boost::asio::buffer(message),
+    boost::asio::buffer("\n", message.empty() || message.back() != '\n' ? 1 : 0)
+  };
+  std::lock_guard<std::mutex> lock(mMutex);
+  // a write to a connection closed by the server succeeds locally, so check it up front;
+  // message partially written when the connection breaks is sent again in full
+  for (int attempt = 0; attempt < 2; attempt++) {
+    try {
+      if (mSocket.is_open() && closedByPeer()) {
+        mSocket.close();
+      }
+      if (!mSocket.is_open()) {
+        connect();
+      }
+      boost::asio::write(mSocket, buffers);
+      return;
+    } catch (const boost::system::system_error& e) {
+      boost::system::error_code ignored;
+      mSocket.close(ignored);
+      if (attempt > 0) {
+        throw InfluxDBException("Stream::write", e.what());
+      }
+    }
+  }
+}
+
+} // namespace transports
+} // namespace influxdb
@@ -0,0 +1,65 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_STREAM_H
+#define INFLUXDATA_TRANSPORTS_STREAM_H
+
+#include "Transport.h"
+
+#include <boost/asio.hpp>
+#include <mutex>
+#include <string>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief Persistent stream socket connection (base of TCP and Unix stream transports)
+/// Batches are written as newline terminated lines, the connection is reestablished when found closed.
+class Stream : public Transport
+{
+  public:
+    /// \param bufferSize   socket send buffer size in bytes (0 keeps system default)
+    Stream(std::size_t bufferSize);
+
+    virtual ~Stream() = default;
+
+    /// Writes blob to the connection, reconnects once when it fails
+    void send(std::string&& message) override;
+
+    /// Sends shared blob without copying it
+    void sendShared(const std::shared_ptr<const std::string>& message) override;
+
+  protected:
+    /// Opens and connects mSocket
+    virtual void connect() = 0;
+
+    /// Applies socket options common to all streams, to be called by connect()
+    void configure();
+
+    /// Boost Asio I/O functionality
+    boost::asio::io_service mIoService;
+
+    /// Socket of any stream protocol
+    boost::asio::generic::stream_protocol::socket mSocket;
+
+  private:
+    /// Writes message followed by newline (if missing)
+    void write(const std::string& message);
+
+    /// \return true when peer closed the connection (checked without blocking)
+    bool closedByPeer();
+
+    /// Serializes writes of concurrent senders
+    std::mutex mMutex;
+
+    /// Socket send buffer size
+    std::size_t mBufferSize;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_STREAM_H
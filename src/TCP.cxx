@@ -0,0 +1,46 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "TCP.h"
+#include "InfluxDBException.h"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace influxdb
+{
+namespace transports
+{
+
+TCP::TCP(const std::string& hostname, int port, bool noDelay, bool cork, std::size_t bufferSize) :
+  Stream(bufferSize), mHostname(hostname), mPort(port), mNoDelay(noDelay), mCork(cork)
+{
+}
+
+void TCP::connect()
+{
+  boost::asio::ip::tcp::resolver resolver(mIoService);
+  auto results = resolver.resolve(mHostname, std::to_string(mPort));
+  boost::system::error_code error = boost::asio::error::host_not_found;
+  for (const auto& result : results) {
+    boost::asio::generic::stream_protocol::endpoint endpoint(result.endpoint());
+    boost::system::error_code ignored;
+    mSocket.close(ignored);
+    mSocket.open(endpoint.protocol());
+    if (!mSocket.connect(endpoint, error)) {
+      break;
+    }
+  }
+  if (error) {
+    throw boost::system::system_error(error);
+  }
+  configure();
+  mSocket.set_option(boost::asio::ip::tcp::no_delay(mNoDelay));
+#ifdef TCP_CORK
+  mSocket.set_option(boost::asio::detail::socket_option::boolean<IPPROTO_TCP, TCP_CORK>(mCork));
+#endif
+}
+
+} // namespace transports
+} // namespace influxdb
@@ -0,0 +1,49 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_TCP_H
+#define INFLUXDATA_TRANSPORTS_TCP_H
+
+#include "Stream.h"
+
+#include <string>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief TCP transport with persistent connection (eg. Telegraf socket_listener)
+class TCP : public Stream
+{
+  public:
+    /// Constructor, connects on first send
+    /// \param noDelay      disables Nagle's algorithm, each batch goes out without delay
+    /// \param cork         keeps TCP_CORK set (Linux), small batches are coalesced into full segments
+    ///                     and flushed by the kernel within 200 ms
+    /// \param bufferSize   socket send buffer size in bytes
+    TCP(const std::string& hostname, int port, bool noDelay = true, bool cork = false,
+      std::size_t bufferSize = 4 * 1024 * 1024);
+
+  private:
+    /// Resolves hostname (on each reconnect) and connects to the first reachable address
+    void connect() override;
+
+    /// Server hostname
+    std::string mHostname;
+
+    /// Server port
+    int mPort;
+
+    /// Whether to set TCP_NODELAY
+    bool mNoDelay;
+
+    /// Whether to set TCP_CORK
+    bool mCork;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_TCP_H
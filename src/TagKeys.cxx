@@ -0,0 +1,80 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "TagKeys.h"
+
+namespace influxdb
+{
+
+namespace
+{
+
+/// \return unescaped value of tagKey="..." field, empty if the point has none
+std::string tagKey(const std::string& fields)
+{
+  static const std::string prefix = "tagKey=\"";
+  std::string key;
+  if (fields.compare(0, prefix.size(), prefix) != 0 || fields.size() < prefix.size() + 1 || fields.back() != '"') {
+    return key;
+  }
+  for (auto i = prefix.size(); i + 1 < fields.size(); i++) {
+    if (fields[i] == '\\' && i + 2 < fields.size()) {
+      i++;
+    }
+    key += fields[i];
+  }
+  return key;
+}
+
+} // namespace
+
+std::shared_ptr<const TagKeys::Keys> TagKeys::find(std::string_view measurement) const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto found = mKeys.find(measurement);
+  return found != mKeys.end() ? found->second : nullptr;
+}
+
+void TagKeys::update(const std::set<std::string>& measurements, const std::vector<Point>& points)
+{
+  std::map<std::string, Keys, std::less<>> keys;
+  for (const auto& measurement : measurements) {
+    keys[measurement];
+  }
+  for (const auto& point : points) {
+    auto key = tagKey(point.getFields());
+    if (!key.empty()) {
+      keys[point.getName()].insert(std::move(key));
+    }
+  }
+  std::lock_guard<std::mutex> lock(mMutex);
+  for (auto& [measurement, measurementKeys] : keys) {
+    mKeys[measurement] = std::make_shared<const Keys>(std::move(measurementKeys));
+  }
+}
+
+void TagKeys::clear()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mKeys.clear();
+}
+
+std::string TagKeys::Query(const std::set<std::string>& measurements)
+{
+  std::string query = "SHOW TAG KEYS FROM ";
+  bool first = true;
+  for (const auto& measurement : measurements) {
+    if (!first) query += ',';
+    first = false;
+    query += '"';
+    for (char character : measurement) {
+      if (character == '"' || character == '\\') query += '\\';
+      query += character;
+    }
+    query += '"';
+  }
+  return query;
+}
+
+} // namespace influxdb
@@ -0,0 +1,55 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TAGKEYS_H
+#define INFLUXDATA_TAGKEYS_H
+
+#include "Point.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace influxdb
+{
+
+/// \brief Tag keys of measurements, as reported by SHOW TAG KEYS
+/// Query responses of a plain SELECT do not say which string columns are tags; they are classified
+/// with these keys, looked up once per measurement and kept for the lifetime of the client.
+class TagKeys
+{
+  public:
+    /// Tag keys of a measurement
+    using Keys = std::set<std::string, std::less<>>;
+
+    /// \return tag keys of measurement, null when not known yet
+    std::shared_ptr<const Keys> find(std::string_view measurement) const;
+
+    /// Stores tag keys reported by SHOW TAG KEYS, measurements missing in the result have no tags
+    /// \param measurements  measurements the query was sent for
+    /// \param points        decoded result, a point with "tagKey" field per key
+    void update(const std::set<std::string>& measurements, const std::vector<Point>& points);
+
+    /// Drops all known tag keys
+    void clear();
+
+    /// \return SHOW TAG KEYS query of measurements
+    static std::string Query(const std::set<std::string>& measurements);
+
+  private:
+    /// Tag keys by measurement
+    std::map<std::string, std::shared_ptr<const Keys>, std::less<>> mKeys;
+
+    /// Guards mKeys
+    mutable std::mutex mMutex;
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_TAGKEYS_H
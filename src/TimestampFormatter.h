@@ -0,0 +1,98 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TIMESTAMPFORMATTER_H
+#define INFLUXDATA_TIMESTAMPFORMATTER_H
+
+#include "Point.h"
+
+#include <charconv>
+#include <chrono>
+#include <string>
+
+namespace influxdb
+{
+
+/// \return timestamp as number of ticks of given precision since epoch
+inline long long int toTicks(std::chrono::time_point<std::chrono::system_clock> timestamp, Precision precision)
+{
+  auto sinceEpoch = timestamp.time_since_epoch();
+  switch (precision) {
+    case Precision::Seconds:
+      return std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch).count();
+    case Precision::Milliseconds:
+      return std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count();
+    case Precision::Microseconds:
+      return std::chrono::duration_cast<std::chrono::microseconds>(sinceEpoch).count();
+    default:
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(sinceEpoch).count();
+  }
+}
+
+/// \brief Renders timestamps of a batch incrementally
+/// Keeps digits of the previous timestamp; for a non-decreasing sequence only the difference is
+/// added (with carry) to the low order digits instead of converting the whole number again
+class TimestampFormatter
+{
+  public:
+    TimestampFormatter() : mStart(sizeof(mDigits)), mPrevious(0), mValid(false) {}
+
+    /// Appends decimal representation of value
+    void append(std::string& out, long long int value)
+    {
+      if (mValid && value >= mPrevious) {
+        add(static_cast<unsigned long long int>(value - mPrevious));
+      } else {
+        render(value);
+      }
+      mPrevious = value;
+      out.append(mDigits + mStart, sizeof(mDigits) - mStart);
+    }
+
+  private:
+    /// Full conversion
+    void render(long long int value)
+    {
+      char buffer[sizeof(mDigits)];
+      auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+      std::size_t length = result.ptr - buffer;
+      mStart = sizeof(mDigits) - length;
+      std::char_traits<char>::copy(mDigits + mStart, buffer, length);
+      mValid = value >= 0;
+    }
+
+    /// Adds delta to stored digits, touching only the changed suffix
+    void add(unsigned long long int delta)
+    {
+      std::size_t position = sizeof(mDigits);
+      unsigned int carry = 0;
+      while (delta > 0 || carry > 0) {
+        if (position == mStart) {
+          // non-negative long long has at most 19 digits, there is always room for one more
+          mDigits[--mStart] = '0';
+        }
+        position--;
+        unsigned int digit = (mDigits[position] - '0') + static_cast<unsigned int>(delta % 10) + carry;
+        delta /= 10;
+        carry = digit / 10;
+        mDigits[position] = static_cast<char>('0' + digit % 10);
+      }
+    }
+
+    /// Right aligned digits of the previous value
+    char mDigits[24];
+
+    /// Index of first digit
+    std::size_t mStart;
+
+    /// Previous value
+    long long int mPrevious;
+
+    /// Whether digits hold a non-negative previous value
+    bool mValid;
+};
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_TIMESTAMPFORMATTER_H
@@ -0,0 +1,130 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TIMESTAMPPARSER_H
+#define INFLUXDATA_TIMESTAMPPARSER_H
+
+#include "Point.h"
+
+#include <charconv>
+#include <chrono>
+#include <string_view>
+
+namespace influxdb
+{
+
+namespace detail
+{
+/// Parses fixed number of decimal digits
+inline bool parseDigits(std::string_view text, std::size_t position, std::size_t count, int& value)
+{
+  if (position + count > text.size()) return false;
+  value = 0;
+  for (std::size_t i = position; i < position + count; i++) {
+    unsigned int digit = static_cast<unsigned char>(text[i]) - '0';
+    if (digit > 9) return false;
+    value = value * 10 + digit;
+  }
+  return true;
+}
+
+/// Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's days_from_civil)
+inline long long int daysFromCivil(int year, unsigned int month, unsigned int day)
+{
+  year -= month <= 2;
+  const long long int era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned int yearOfEra = static_cast<unsigned int>(year - era * 400);
+  const unsigned int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const unsigned int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + static_cast<long long int>(dayOfEra) - 719468;
+}
+} // namespace detail
+
+/// Parses RFC3339 timestamp with up to nanosecond fraction, eg. 2019-11-04T01:28:34.123456789Z
+/// or 2019-11-04T02:28:34+01:00; independent of locale and local timezone
+/// \return false if text is malformed
+inline bool parseRfc3339(std::string_view text, std::chrono::time_point<std::chrono::system_clock>& timestamp)
+{
+  int year, month, day, hour, minute, second;
+  if (!detail::parseDigits(text, 0, 4, year) || text.size() < 20 || text[4] != '-'
+      || !detail::parseDigits(text, 5, 2, month) || text[7] != '-'
+      || !detail::parseDigits(text, 8, 2, day) || (text[10] != 'T' && text[10] != 't' && text[10] != ' ')
+      || !detail::parseDigits(text, 11, 2, hour) || text[13] != ':'
+      || !detail::parseDigits(text, 14, 2, minute) || text[16] != ':'
+      || !detail::parseDigits(text, 17, 2, second)
+      || month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+    return false;
+  }
+
+  std::size_t position = 19;
+  long long int nanoseconds = 0;
+  if (text[position] == '.') {
+    int digits = 0;
+    for (position++; position < text.size() && text[position] >= '0' && text[position] <= '9'; position++) {
+      if (digits++ < 9) nanoseconds = nanoseconds * 10 + (text[position] - '0');
+    }
+    if (digits == 0) return false;
+    for (; digits < 9; digits++) nanoseconds *= 10;
+  }
+
+  long long int offset = 0;
+  if (position == text.size() - 1 && (text[position] == 'Z' || text[position] == 'z')) {
+    offset = 0;
+  } else if (position + 6 == text.size() && (text[position] == '+' || text[position] == '-') && text[position + 3] == ':') {
+    int offsetHours, offsetMinutes;
+    if (!detail::parseDigits(text, position + 1, 2, offsetHours) || !detail::parseDigits(text, position + 4, 2, offsetMinutes)) {
+      return false;
+    }
+    offset = (offsetHours * 3600LL + offsetMinutes * 60LL) * (text[position] == '+' ? 1 : -1);
+  } else {
+    return false;
+  }
+
+  long long int seconds = detail::daysFromCivil(year, month, day) * 86400LL + hour * 3600LL + minute * 60LL + second - offset;
+  timestamp = std::chrono::time_point<std::chrono::system_clock>(
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+      std::chrono::seconds(seconds) + std::chrono::nanoseconds(nanoseconds)
+    )
+  );
+  return true;
+}
+
+/// \return time point of integer timestamp expressed in given precision
+inline std::chrono::time_point<std::chrono::system_clock> fromTicks(long long int value, Precision precision)
+{
+  std::chrono::nanoseconds sinceEpoch;
+  switch (precision) {
+    case Precision::Seconds:
+      sinceEpoch = std::chrono::seconds(value);
+      break;
+    case Precision::Milliseconds:
+      sinceEpoch = std::chrono::milliseconds(value);
+      break;
+    case Precision::Microseconds:
+      sinceEpoch = std::chrono::microseconds(value);
+      break;
+    default:
+      sinceEpoch = std::chrono::nanoseconds(value);
+  }
+  return std::chrono::time_point<std::chrono::system_clock>(
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceEpoch)
+  );
+}
+
+/// Parses integer timestamp (query with epoch=) expressed in given precision
+/// \return false if text is not an integer
+inline bool parseEpoch(std::string_view text, Precision precision, std::chrono::time_point<std::chrono::system_clock>& timestamp)
+{
+  long long int value;
+  auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+    return false;
+  }
+  timestamp = fromTicks(value, precision);
+  return true;
+}
+
+} // namespace influxdb
+
+#endif // INFLUXDATA_TIMESTAMPPARSER_H
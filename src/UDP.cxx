@@ -11,22 +11,140 @@ namespace influxdb
 namespace transports
 {
 
-UDP::UDP(const std::string &hostname, int port) :
-  mSocket(mIoService, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0))
+/// Delay of retrying failed first resolution
+static constexpr std::chrono::seconds RetryDelay{1};
+
+struct UDP::Resolution
+{
+  Resolution(std::shared_ptr<IoContext> ioContext) :
+    context(std::move(ioContext)), strand(boost::asio::make_strand(context->get())),
+    resolver(context->get()), timer(context->get())
+  {
+  }
+
+  /// Marks asynchronous operation completed
+  void finish()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    outstanding--;
+    done.notify_all();
+  }
+
+  /// Marks asynchronous operation started
+  /// \param force   start even when stopping
+  /// \return false if stopping (operation must not start)
+  bool begin(bool force = false)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping && !force) {
+      return false;
+    }
+    outstanding++;
+    return true;
+  }
+
+  std::shared_ptr<IoContext> context;
+  boost::asio::strand<boost::asio::io_context::executor_type> strand;
+  boost::asio::ip::udp::resolver resolver;
+  boost::asio::steady_timer timer;
+  std::mutex mutex;
+  std::condition_variable done;
+  std::size_t outstanding = 0;
+  bool stopping = false;
+  bool resolved = false;
+};
+
+UDP::UDP(const std::string &hostname, int port, std::shared_ptr<IoContext> context, std::size_t maxPending,
+  std::chrono::seconds resolveInterval) :
+  mDatagram(context, maxPending), mHostname(hostname), mPort(std::to_string(port)), mResolveInterval(resolveInterval)
 {
-    boost::asio::ip::udp::resolver resolver(mIoService);
-    boost::asio::ip::udp::resolver::query query(boost::asio::ip::udp::v4(), hostname, std::to_string(port));
-    boost::asio::ip::udp::resolver::iterator resolverInerator = resolver.resolve(query);
-    mEndpoint = *resolverInerator;
+  mDatagram.socket().open(boost::asio::ip::udp::v4());
+  mDatagram.socket().bind(boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+
+  boost::system::error_code error;
+  auto address = boost::asio::ip::make_address_v4(hostname, error);
+  if (!error) {
+    mDatagram.endpoint(boost::asio::ip::udp::endpoint(address, static_cast<unsigned short>(port)));
+    return;
+  }
+  mResolution = std::make_unique<Resolution>(context ? context : IoContext::Get());
+  mResolution->begin();
+  boost::asio::post(mResolution->strand, [this] {
+    resolve();
+    mResolution->finish();
+  });
 }
 
-void UDP::send(std::string&& message)
+/// Waits for resolution in progress (getaddrinfo cannot be interrupted anyway), so that held messages are sent
+UDP::~UDP()
 {
-  try {
-    mSocket.send_to(boost::asio::buffer(message, message.size()), mEndpoint);
-  } catch(const boost::system::system_error& e) {
-    throw InfluxDBException("UDP::send", e.what());
+  if (!mResolution) {
+    return;
   }
+  {
+    std::lock_guard<std::mutex> lock(mResolution->mutex);
+    mResolution->stopping = true;
+    mResolution->outstanding++;
+  }
+  boost::asio::post(mResolution->strand, [this] {
+    mResolution->timer.cancel();
+    mResolution->finish();
+  });
+  std::unique_lock<std::mutex> lock(mResolution->mutex);
+  mResolution->done.wait(lock, [this] { return mResolution->outstanding == 0; });
+}
+
+void UDP::resolve()
+{
+  // first resolution completes even when stopping, so that held messages are sent
+  if (!mResolution->begin(!mResolution->resolved)) {
+    return;
+  }
+  mResolution->resolver.async_resolve(boost::asio::ip::udp::v4(), mHostname, mPort,
+    boost::asio::bind_executor(mResolution->strand,
+      [this](const boost::system::error_code& error, boost::asio::ip::udp::resolver::results_type results) {
+        if (!error && !results.empty()) {
+          mDatagram.endpoint(*results.begin());
+          mResolution->resolved = true;
+        }
+        // until the first success retry soon, afterwards keep the last endpoint
+        if (!mResolution->resolved) {
+          schedule(RetryDelay);
+        } else if (mResolveInterval.count() > 0) {
+          schedule(mResolveInterval);
+        }
+        mResolution->finish();
+      }));
+}
+
+void UDP::schedule(std::chrono::steady_clock::duration delay)
+{
+  if (!mResolution->begin()) {
+    return;
+  }
+  mResolution->timer.expires_after(delay);
+  mResolution->timer.async_wait(boost::asio::bind_executor(mResolution->strand,
+    [this](const boost::system::error_code& error) {
+      if (!error) {
+        resolve();
+      }
+      mResolution->finish();
+    }));
+}
+
+void UDP::send(std::string&& message)
+{
+  mDatagram.send(std::move(message), "UDP::sendTo");
+}
+
+void UDP::sendShared(const std::shared_ptr<const std::string>& message)
+{
+  mDatagram.sendShared(message, "UDP::sendTo");
+}
+
+std::size_t UDP::dropped() const
+{
+  return mDatagram.dropped();
 }
 
 } // namespace transports
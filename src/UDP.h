@@ -6,6 +6,7 @@
 #define INFLUXDATA_TRANSPORTS_UDP_H
 
 #include "Transport.h"
+#include "Datagram.h"
 
 #include <boost/asio.hpp>
 #include <chrono>
@@ -17,28 +18,54 @@ namespace transports
 {
 
 /// \brief UDP transport
+/// Hostname is resolved in background (and periodically re-resolved), messages sent before the first resolution
+/// completes are held; construction never waits for DNS.
 class UDP : public Transport
 {
   public:
     /// Constructor
-    UDP(const std::string &hostname, int port);
+    /// \param context           shared context to send asynchronously on, synchronous sends when null
+    /// \param maxPending        maximum number of queued or held messages, more are dropped
+    /// \param resolveInterval   period of re-resolving the hostname, 0 resolves only once
+    UDP(const std::string &hostname, int port, std::shared_ptr<IoContext> context = nullptr,
+      std::size_t maxPending = 1024, std::chrono::seconds resolveInterval = std::chrono::seconds(60));
 
-    /// Default destructor
-    ~UDP() = default;
+    /// Stops resolution
+    ~UDP();
  
     /// Sends blob via UDP
-    void send(std::string&& message) override;   
+    void send(std::string&& message) override;
+
+    /// Sends shared blob without copying it
+    void sendShared(const std::shared_ptr<const std::string>& message) override;
+
+    /// \return number of messages dropped (queue full, failed asynchronous send, or hostname not resolved in time)
+    std::size_t dropped() const override;
 
   private:
-    /// Boost Asio I/O functionality
-    boost::asio::io_service mIoService;
+    /// Background resolution state
+    struct Resolution;
+
+    /// Starts resolving hostname, runs in resolution strand
+    void resolve();
+
+    /// Schedules next resolution, runs in resolution strand
+    void schedule(std::chrono::steady_clock::duration delay);
+
+    /// UDP socket and endpoint
+    Datagram<boost::asio::ip::udp> mDatagram;
+
+    /// Server hostname
+    std::string mHostname;
 
-    /// UDP socket
-    boost::asio::ip::udp::socket mSocket;
+    /// Server port
+    std::string mPort;
 
-    /// UDP endpoint
-    boost::asio::ip::udp::endpoint mEndpoint;
+    /// Period of re-resolving
+    std::chrono::seconds mResolveInterval;
 
+    /// Resolution state, null if hostname is an address
+    std::unique_ptr<Resolution> mResolution;
 };
 
 } // namespace transports
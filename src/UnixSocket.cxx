@@ -12,19 +12,26 @@ namespace influxdb
 namespace transports
 {
 #if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
-UnixSocket::UnixSocket(const std::string &socketPath) :
-  mSocket(mIoService), mEndpoint(socketPath)
+UnixSocket::UnixSocket(const std::string &socketPath, std::shared_ptr<IoContext> context, std::size_t maxPending) :
+  mDatagram(std::move(context), maxPending)
 {
-  mSocket.open();
+  mDatagram.socket().open();
+  mDatagram.endpoint(socketPath);
 }
 
 void UnixSocket::send(std::string&& message)
 {
-  try {
-    mSocket.send_to(boost::asio::buffer(message, message.size()), mEndpoint);
-  } catch(const boost::system::system_error& e) {
-    throw InfluxDBException("UnixSocket::send", e.what());
-  }
+  mDatagram.send(std::move(message), "UnixSocket::sendTo");
+}
+
+void UnixSocket::sendShared(const std::shared_ptr<const std::string>& message)
+{
+  mDatagram.sendShared(message, "UnixSocket::sendTo");
+}
+
+std::size_t UnixSocket::dropped() const
+{
+  return mDatagram.dropped();
 }
 #endif // defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
 
@@ -6,6 +6,7 @@
 #define INFLUXDATA_TRANSPORTS_UNIX_H
 
 #include "Transport.h"
+#include "Datagram.h"
 
 #include <boost/asio.hpp>
 #include <string>
@@ -19,23 +20,27 @@ namespace transports
 class UnixSocket : public Transport
 {
   public:
-    UnixSocket(const std::string &socketPath);
+    /// \param context      shared context to send asynchronously on, synchronous sends when null
+    /// \param maxPending   maximum number of queued messages in asynchronous mode, more are dropped
+    UnixSocket(const std::string &socketPath, std::shared_ptr<IoContext> context = nullptr,
+      std::size_t maxPending = 1024);
 
     /// Default destructor
     ~UnixSocket() = default;
  
     /// \param message   r-value string formated
-    void send(std::string&& message) override;   
+    void send(std::string&& message) override;
+
+    /// Sends shared blob without copying it
+    void sendShared(const std::shared_ptr<const std::string>& message) override;
 
-  private:
-    /// Boost Asio I/O functionality
-    boost::asio::io_service mIoService;
 #if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
-    /// Unix socket
-    boost::asio::local::datagram_protocol::socket mSocket;
+    /// \return number of messages dropped in asynchronous mode
+    std::size_t dropped() const override;
 
-    /// Unix endpoint
-    boost::asio::local::datagram_protocol::endpoint mEndpoint;
+  private:
+    /// Unix socket and endpoint
+    Datagram<boost::asio::local::datagram_protocol> mDatagram;
 #endif // defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
 };
 
@@ -0,0 +1,31 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+
+#include "UnixStream.h"
+#include "InfluxDBException.h"
+
+namespace influxdb
+{
+namespace transports
+{
+
+UnixStream::UnixStream(const std::string& socketPath, std::size_t bufferSize) :
+  Stream(bufferSize), mSocketPath(socketPath)
+{
+}
+
+void UnixStream::connect()
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  boost::asio::generic::stream_protocol::endpoint endpoint(boost::asio::local::stream_protocol::endpoint{mSocketPath});
+  mSocket.open(endpoint.protocol());
+  mSocket.connect(endpoint);
+  configure();
+#else
+  throw InfluxDBException("UnixStream::connect", "Unix sockets are not supported on this platform");
+#endif // defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+}
+
+} // namespace transports
+} // namespace influxdb
@@ -0,0 +1,36 @@
+///
+/// \author Adam Wegrzynek
+///
+
+#ifndef INFLUXDATA_TRANSPORTS_UNIXSTREAM_H
+#define INFLUXDATA_TRANSPORTS_UNIXSTREAM_H
+
+#include "Stream.h"
+
+#include <string>
+
+namespace influxdb
+{
+namespace transports
+{
+
+/// \brief Unix stream socket transport with persistent connection
+class UnixStream : public Stream
+{
+  public:
+    /// Constructor, connects on first send
+    /// \param bufferSize   socket send buffer size in bytes
+    UnixStream(const std::string& socketPath, std::size_t bufferSize = 4 * 1024 * 1024);
+
+  private:
+    /// Connects to socket path
+    void connect() override;
+
+    /// Path of the socket
+    std::string mSocketPath;
+};
+
+} // namespace transports
+} // namespace influxdb
+
+#endif // INFLUXDATA_TRANSPORTS_UNIXSTREAM_H
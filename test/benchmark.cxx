@@ -1,5 +1,7 @@
 #include  <InfluxDBFactory.h>
 #include <boost/program_options.hpp>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
 using namespace influxdb;
@@ -28,11 +30,15 @@ int main(int argc, char* argv[]) {
     db->batchOf(vm["buffer"].as<int>());
   }
 
+  auto start = std::chrono::steady_clock::now();
   for(int i = 0; i <= count; i++) {
     db->write(Point{"int"}.addField("value1", 10).addField("value2", "11").addTag("tag1", "machine"));
     db->write(Point{"double"}.addField("value1", 10.10).addField("value2", "11.11").addTag("tag1", "machine"));
   }
+  db->flushBuffer();
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
   std::cout << "Written " << 2*count-1 << " points";
   if (vm.count("buffer")) { std::cout << " through " << vm["buffer"].as<int>(); }
-  std::cout << " to " << vm["url"].as<std::string>() << std::endl;
+  std::cout << " to " << vm["url"].as<std::string>();
+  std::cout << " in " << elapsed * 1000 << " ms (" << (2*count-1) / elapsed << " points/s)" << std::endl;
 }
@@ -0,0 +1,74 @@
+#include <InfluxDBFactory.h>
+#include <LineProtocolParser.h>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+using namespace influxdb;
+
+/// Generates line protocol of typical points
+std::string generate(int lines)
+{
+  std::string data;
+  for (int i = 0; i < lines; i++) {
+    data += Point{"cpu"}
+      .addTag("host", "server" + std::to_string(i % 100)).addTag("region", "eu-west").addTag("cpu", "cpu-total")
+      .addField("usage_user", 0.1 * i).addField("usage_system", i % 1000).addField("active", i % 2 == 0)
+      .addField("state", "running")
+      .toLineProtocol();
+    data += '\n';
+  }
+  return data;
+}
+
+int main(int argc, char* argv[]) {
+
+  boost::program_options::options_description desc("Allowed options");
+  desc.add_options()
+    ("lines", boost::program_options::value<int>()->default_value(1000000), "Number of generated lines")
+    ("file", boost::program_options::value<std::string>(), "Line protocol file to parse instead (memory mapped)")
+    ("runs", boost::program_options::value<int>()->default_value(5), "Runs, best one is reported");
+
+  boost::program_options::variables_map vm;
+  boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+  boost::program_options::notify(vm);
+
+  std::string generated;
+  std::unique_ptr<LineProtocolParser::MappedFile> file;
+  std::string_view data;
+  if (vm.count("file")) {
+    file = std::make_unique<LineProtocolParser::MappedFile>(vm["file"].as<std::string>());
+    data = file->data();
+  } else {
+    generated = generate(vm["lines"].as<int>());
+    data = generated;
+  }
+
+  double best = 0, bestSplit = 0;
+  std::size_t records = 0, fields = 0;
+  for (int run = 0; run < vm["runs"].as<int>(); run++) {
+    // splitting lines only, upper bound of parsing
+    auto start = std::chrono::steady_clock::now();
+    std::size_t lines = 0;
+    for (auto position = data.data(), end = data.data() + data.size(); position < end; lines++) {
+      auto newline = static_cast<const char*>(std::memchr(position, '\n', end - position));
+      position = newline ? newline + 1 : end;
+    }
+    bestSplit = std::max(bestSplit, data.size() / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    start = std::chrono::steady_clock::now();
+    LineProtocolParser parser(data);
+    LineProtocolParser::Record record;
+    records = fields = 0;
+    while (parser.next(record)) {
+      records++;
+      fields += record.fields.size();
+    }
+    best = std::max(best, data.size() / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    if (lines < records) return 1;
+  }
+  std::cout << "Parsed " << records << " lines (" << fields << " fields, " << data.size() / 1e6 << " MB) at "
+    << best / 1e9 << " GB/s, " << records * best / data.size() / 1e6 << " M lines/s"
+    << " (line split only: " << bestSplit / 1e9 << " GB/s)" << std::endl;
+}
@@ -0,0 +1,177 @@
+#include <InfluxDBFactory.h>
+#include "../src/TimestampParser.h"
+#include "../src/JsonDecoder.h"
+#include "../src/MsgPackDecoder.h"
+#include <boost/lexical_cast.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/program_options.hpp>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace influxdb;
+
+/// Appends MessagePack string
+void packString(std::string& data, const std::string& value)
+{
+  data += '\xd9';
+  data += static_cast<char>(value.size());
+  data += value;
+}
+
+/// Appends MessagePack big endian number with given type marker
+template<typename T>
+void packNumber(std::string& data, char type, T value)
+{
+  std::uint64_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(T));
+  data += type;
+  for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+    data += static_cast<char>((bits >> shift) & 0xff);
+  }
+}
+
+template<typename Function>
+void measure(const std::string& name, std::size_t rows, Function function)
+{
+  auto start = std::chrono::steady_clock::now();
+  long long int checksum = function();
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << name << ": " << elapsed * 1000 << " ms (" << rows / elapsed << " rows/s, checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+
+  std::size_t rows = 1000000;
+  std::size_t decodeRows = 100000;
+
+  boost::program_options::options_description desc("Allowed options");
+  desc.add_options()
+    ("rows", boost::program_options::value<std::size_t>(), "Number of timestamps to parse")
+    ("decodeRows", boost::program_options::value<std::size_t>(), "Number of rows of decoded response");
+
+  boost::program_options::variables_map vm;
+  boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+  boost::program_options::notify(vm);
+
+  if (vm.count("rows")) {
+    rows = vm["rows"].as<std::size_t>();
+  }
+  if (vm.count("decodeRows")) {
+    decodeRows = vm["decodeRows"].as<std::size_t>();
+  }
+
+  std::vector<std::string> rfc3339, epoch;
+  auto base = std::chrono::system_clock::time_point(std::chrono::seconds(1572830914));
+  for (std::size_t i = 0; i < rows; i++) {
+    auto timestamp = base + std::chrono::milliseconds(i * 10);
+    auto seconds = std::chrono::system_clock::to_time_t(timestamp);
+    std::ostringstream stream;
+    stream << std::put_time(std::gmtime(&seconds), "%Y-%m-%dT%H:%M:%S") << "."
+           << std::setw(3) << std::setfill('0') << (i * 10) % 1000 << "Z";
+    rfc3339.push_back(stream.str());
+    epoch.push_back(std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count()));
+  }
+
+  measure("stringstream + get_time + mktime", rows, [&rfc3339] {
+    long long int checksum = 0;
+    for (const auto& value : rfc3339) {
+      std::tm tm = {};
+      std::stringstream ss;
+      ss << value;
+      ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%SZ");
+      checksum += std::mktime(&tm);
+    }
+    return checksum;
+  });
+
+  measure("parseRfc3339", rows, [&rfc3339] {
+    long long int checksum = 0;
+    std::chrono::time_point<std::chrono::system_clock> timestamp;
+    for (const auto& value : rfc3339) {
+      parseRfc3339(value, timestamp);
+      checksum += std::chrono::duration_cast<std::chrono::seconds>(timestamp.time_since_epoch()).count();
+    }
+    return checksum;
+  });
+
+  measure("parseEpoch (epoch=ns)", rows, [&epoch] {
+    long long int checksum = 0;
+    std::chrono::time_point<std::chrono::system_clock> timestamp;
+    for (const auto& value : epoch) {
+      parseEpoch(value, Precision::Nanoseconds, timestamp);
+      checksum += std::chrono::duration_cast<std::chrono::seconds>(timestamp.time_since_epoch()).count();
+    }
+    return checksum;
+  });
+
+  // string heavy response: three string columns per row
+  std::string json = R"({"results":[{"statement_id":0,"series":[{"name":"requests","columns":["time","host","path","status","latency"],"values":[)";
+  for (std::size_t i = 0; i < decodeRows; i++) {
+    if (i > 0) json += ",";
+    json += "[" + epoch[i % epoch.size()] + ",\"host" + std::to_string(i % 50) + "\",\"/api/v1/resource/" + std::to_string(i % 1000)
+      + "\",\"OK\"," + std::to_string(i % 100) + ".25]";
+  }
+  json += "]}]}]}";
+
+  measure("property_tree + lexical_cast (" + std::to_string(json.size() / 1024) + " KiB)", decodeRows, [&json] {
+    std::stringstream ss;
+    ss << json;
+    boost::property_tree::ptree pt;
+    boost::property_tree::read_json(ss, pt);
+    std::vector<Point> points;
+    for (auto& result : pt.get_child("results")) {
+      for (auto& series : result.second.get_child("series")) {
+        auto columns = series.second.get_child("columns");
+        for (auto& values : series.second.get_child("values")) {
+          Point point{series.second.get<std::string>("name")};
+          auto iColumns = columns.begin();
+          auto iValues = values.second.begin();
+          for (; iColumns != columns.end() && iValues != values.second.end(); iColumns++, iValues++) {
+            auto value = iValues->second.get_value<std::string>();
+            auto column = iColumns->second.get_value<std::string>();
+            if (!column.compare("time")) continue;
+            try { point.addField(column, boost::lexical_cast<double>(value)); }
+            catch(...) { point.addTag(column, value); }
+          }
+          points.push_back(std::move(point));
+        }
+      }
+    }
+    return static_cast<long long int>(points.size());
+  });
+
+  measure("JsonDecoder", decodeRows, [&json] {
+    ResultBuilder builder(Precision::Nanoseconds);
+    JsonDecoder::Decode(json, builder);
+    return static_cast<long long int>(builder.results().at(0).size());
+  });
+
+  // same response as InfluxDB encodes it for Accept: application/x-msgpack
+  std::string msgpack = "\x81\xa7" "results" "\x91\x82\xa2" "id";
+  msgpack += '\0';
+  msgpack += "\xa6" "series" "\x91\x83\xa4" "name" "\xa8" "requests" "\xa7" "columns" "\x95";
+  for (auto column : {"time", "host", "path", "status", "latency"}) {
+    packString(msgpack, column);
+  }
+  msgpack += "\xa6" "values";
+  packNumber(msgpack, '\xdd', static_cast<std::uint32_t>(decodeRows));
+  for (std::size_t i = 0; i < decodeRows; i++) {
+    msgpack += '\x95';
+    packNumber(msgpack, '\xd3', std::stoll(epoch[i % epoch.size()]));
+    packString(msgpack, "host" + std::to_string(i % 50));
+    packString(msgpack, "/api/v1/resource/" + std::to_string(i % 1000));
+    packString(msgpack, "OK");
+    packNumber(msgpack, '\xcb', (i % 100) + 0.25);
+  }
+
+  measure("MsgPackDecoder (" + std::to_string(msgpack.size() / 1024) + " KiB)", decodeRows, [&msgpack] {
+    ResultBuilder builder(Precision::Nanoseconds);
+    MsgPackDecoder::Decode(msgpack, builder);
+    return static_cast<long long int>(builder.results().at(0).size());
+  });
+}
@@ -0,0 +1,45 @@
+#include <InfluxDBFactory.h>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <iostream>
+
+using namespace influxdb;
+
+/// \return milliseconds elapsed since start
+double since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+
+  boost::program_options::options_description desc("Allowed options");
+  desc.add_options()
+    ("url", boost::program_options::value<std::vector<std::string>>()->required(), "URL of transport (repeatable)")
+    ("writes", boost::program_options::value<int>()->default_value(10), "Points written right after start");
+
+  boost::program_options::variables_map vm;
+  boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+  boost::program_options::notify(vm);
+
+  // time until a service can write, i.e. cost of creating the client on the startup path
+  for (const auto& url : vm["url"].as<std::vector<std::string>>()) {
+    auto start = std::chrono::steady_clock::now();
+    auto db = InfluxDBFactory::Get(url);
+    auto created = since(start);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < vm["writes"].as<int>(); i++) {
+      try {
+        db->write(Point{"startup"}.addField("value", i));
+      } catch (const std::exception& e) {
+        std::cout << "Write failed: " << e.what() << std::endl;
+        break;
+      }
+    }
+    auto written = since(start);
+    start = std::chrono::steady_clock::now();
+    db.reset();
+    std::cout << url << ": created in " << created << " ms, " << vm["writes"].as<int>() << " writes in "
+      << written << " ms, destroyed in " << since(start) << " ms" << std::endl;
+  }
+}
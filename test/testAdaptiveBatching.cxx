@@ -0,0 +1,161 @@
+#define BOOST_TEST_MODULE Test InfluxDB Adaptive Batching
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
+#include "../src/BatchTuner.h"
+
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <sys/socket.h>
+
+namespace influxdb {
+namespace test {
+
+using boost::asio::ip::tcp;
+
+/// HTTP write endpoint answering after a latency growing with the number of received lines
+class MockServer
+{
+  public:
+    MockServer(std::chrono::microseconds base, std::chrono::microseconds perLine) :
+      acceptor(service, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0)), base(base), perLine(perLine.count())
+    {
+      mAcceptor = std::thread([this] {
+        for (;;) {
+          auto connection = std::make_shared<tcp::socket>(service);
+          boost::system::error_code error;
+          acceptor.accept(*connection, error);
+          if (error || stopping) return;
+          std::lock_guard<std::mutex> lock(mMutex);
+          mConnections.push_back(connection);
+          mThreads.emplace_back([this, connection] { serve(*connection); });
+        }
+      });
+    }
+    ~MockServer() {
+      stopping = true;
+      tcp::socket wake(service);
+      wake.connect(acceptor.local_endpoint());
+      mAcceptor.join();
+      std::lock_guard<std::mutex> lock(mMutex);
+      for (auto& connection : mConnections) ::shutdown(connection->native_handle(), SHUT_RDWR);
+      for (auto& thread : mThreads) thread.join();
+    }
+    std::string url() {
+      return "http://127.0.0.1:" + std::to_string(acceptor.local_endpoint().port()) + "/?db=test";
+    }
+
+    boost::asio::io_service service;
+    tcp::acceptor acceptor;
+    std::chrono::microseconds base;
+    std::atomic<long long> perLine;
+    std::atomic<bool> stopping{false};
+
+  private:
+    void serve(tcp::socket& connection) {
+      boost::asio::streambuf buffer;
+      boost::system::error_code error;
+      for (;;) {
+        auto headerSize = boost::asio::read_until(connection, buffer, "\r\n\r\n", error);
+        if (error) return;
+        std::string header(boost::asio::buffers_begin(buffer.data()),
+          boost::asio::buffers_begin(buffer.data()) + headerSize);
+        buffer.consume(headerSize);
+        std::transform(header.begin(), header.end(), header.begin(), ::tolower);
+        std::size_t length = 0;
+        auto field = header.find("content-length:");
+        if (field != std::string::npos) length = std::stoul(header.substr(field + 15));
+        if (header.find("expect: 100-continue") != std::string::npos) {
+          boost::asio::write(connection, boost::asio::buffer(std::string("HTTP/1.1 100 Continue\r\n\r\n")), error);
+        }
+        if (buffer.size() < length) {
+          boost::asio::read(connection, buffer, boost::asio::transfer_exactly(length - buffer.size()), error);
+          if (error) return;
+        }
+        std::string body(boost::asio::buffers_begin(buffer.data()), boost::asio::buffers_begin(buffer.data()) + length);
+        buffer.consume(length);
+        auto lines = std::count(body.begin(), body.end(), '\n');
+        std::this_thread::sleep_for(base + std::chrono::microseconds(perLine * lines));
+        boost::asio::write(connection, boost::asio::buffer(std::string("HTTP/1.1 204 No Content\r\n\r\n")), error);
+        if (error) return;
+      }
+    }
+
+    std::thread mAcceptor;
+    std::mutex mMutex;
+    std::vector<std::shared_ptr<tcp::socket>> mConnections;
+    std::vector<std::thread> mThreads;
+};
+
+BOOST_AUTO_TEST_CASE(additiveIncreaseMultiplicativeDecrease)
+{
+  BatchTuner tuner(10, 330, std::chrono::milliseconds(10), std::chrono::seconds(1));
+  BOOST_CHECK_EQUAL(tuner.size(), 10);
+  tuner.record(10, std::chrono::milliseconds(1), false);
+  BOOST_CHECK_EQUAL(tuner.size(), 21);
+  // partial batch says nothing about larger ones
+  tuner.record(5, std::chrono::milliseconds(1), false);
+  BOOST_CHECK_EQUAL(tuner.size(), 21);
+  tuner.record(21, std::chrono::milliseconds(20), false);
+  BOOST_CHECK_EQUAL(tuner.size(), 10);
+  for (int i = 0; i < 100; i++) {
+    tuner.record(tuner.size(), std::chrono::milliseconds(1), false);
+  }
+  BOOST_CHECK_EQUAL(tuner.size(), 330);
+  tuner.record(330, std::chrono::milliseconds(1), true);
+  BOOST_CHECK_EQUAL(tuner.size(), 165);
+  BOOST_CHECK_EQUAL(tuner.latency().count(), 1000);
+  BOOST_CHECK_EQUAL(tuner.interval().count(), 2);
+  BOOST_CHECK_CLOSE(tuner.throughput(), 330 * 1000.0, 1);
+}
+
+BOOST_AUTO_TEST_CASE(flushAfterInterval)
+{
+  auto influxdb = InfluxDBFactory::Get("memory://adaptive");
+  influxdb->adaptiveBatching(100, 1000, std::chrono::milliseconds(10), std::chrono::milliseconds(20));
+  auto start = std::chrono::steady_clock::now();
+  influxdb->write(Point{"test"}.addField("value", 1));
+  // no further write, the partial batch is flushed in background
+  std::vector<std::string> batches;
+  while (batches.empty() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    batches = transports::Memory::Drain("adaptive");
+  }
+  BOOST_CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20));
+  BOOST_REQUIRE_EQUAL(batches.size(), 1);
+  BOOST_CHECK_EQUAL(std::count(batches[0].begin(), batches[0].end(), '\n'), 1);
+  transports::Memory::Release("adaptive");
+}
+
+BOOST_AUTO_TEST_CASE(followsServerLatency)
+{
+  MockServer server(std::chrono::milliseconds(2), std::chrono::microseconds(10));
+  auto influxdb = InfluxDBFactory::Get(server.url());
+  influxdb->adaptiveBatching(10, 4000, std::chrono::milliseconds(20));
+  for (int i = 0; i < 40000; i++) {
+    influxdb->write(Point{"test"}.addField("value", i));
+  }
+  // 2 ms + 10 us per line reaches 20 ms at 1800 lines
+  auto stats = influxdb->stats();
+  BOOST_TEST_MESSAGE("batch size " << stats.batchSize << ", latency " << stats.sendLatency.count() << " us");
+  BOOST_CHECK(stats.batchSize >= 600 && stats.batchSize <= 2500);
+  BOOST_CHECK(stats.sendLatency < std::chrono::milliseconds(30));
+  BOOST_CHECK(stats.throughput > 0);
+
+  // slower server: 20 ms at 180 lines
+  server.perLine = 100;
+  for (int i = 0; i < 10000; i++) {
+    influxdb->write(Point{"test"}.addField("value", i));
+  }
+  stats = influxdb->stats();
+  BOOST_TEST_MESSAGE("batch size " << stats.batchSize << ", latency " << stats.sendLatency.count() << " us");
+  BOOST_CHECK(stats.batchSize >= 40 && stats.batchSize <= 450);
+}
+
+} // namespace test
+} // namespace influxdb
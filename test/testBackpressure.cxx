@@ -0,0 +1,144 @@
+#define BOOST_TEST_MODULE Test InfluxDB Backpressure
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDB.h"
+#include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
+#include "../src/InfluxDBException.h"
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace influxdb {
+namespace test {
+
+/// Transport holding each transmission until opened, simulates slow server
+class Gated : public Transport
+{
+  public:
+    void send(std::string&&) override {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mEntered = true;
+      mCondition.notify_all();
+      mCondition.wait(lock, [this] { return mOpen; });
+    }
+    void waitEntered() {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this] { return mEntered; });
+    }
+    void open() {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mOpen = true;
+      mCondition.notify_all();
+    }
+  private:
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mEntered = false;
+    bool mOpen = false;
+};
+
+Point point()
+{
+  return Point{"test"}.addField("value", 10);
+}
+
+BOOST_AUTO_TEST_CASE(dropWhenExhausted)
+{
+  auto gated = new Gated;
+  InfluxDB influxdb{std::unique_ptr<Transport>(gated)};
+  influxdb.memoryBudget(point().size() * 3 / 2, Backpressure::Drop);
+
+  std::thread stuck([&] { influxdb.write(point()); });
+  gated->waitEntered();
+  BOOST_CHECK_EQUAL(influxdb.stats().pendingBytes, point().size());
+  BOOST_CHECK(!influxdb.tryWrite(point()));
+  influxdb.write(point());
+  BOOST_CHECK_EQUAL(influxdb.stats().dropped, 2);
+
+  gated->open();
+  stuck.join();
+  BOOST_CHECK(influxdb.tryWrite(point()));
+  auto stats = influxdb.stats();
+  BOOST_CHECK_EQUAL(stats.written, 2);
+  BOOST_CHECK_EQUAL(stats.pendingBytes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(blockWithTimeout)
+{
+  auto gated = new Gated;
+  InfluxDB influxdb{std::unique_ptr<Transport>(gated)};
+  influxdb.memoryBudget(point().size(), Backpressure::Block, std::chrono::milliseconds(20));
+
+  std::thread stuck([&] { influxdb.write(point()); });
+  gated->waitEntered();
+  BOOST_CHECK_THROW(influxdb.write(point()), InfluxDBException);
+  BOOST_CHECK(!influxdb.tryWrite(point()));
+
+  // blocked writer proceeds once the transmission completes
+  influxdb.memoryBudget(point().size(), Backpressure::Block, std::chrono::seconds(10));
+  std::thread opener([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    gated->open();
+  });
+  influxdb.write(point());
+  opener.join();
+  stuck.join();
+  BOOST_CHECK_EQUAL(influxdb.stats().written, 2);
+  BOOST_CHECK_EQUAL(influxdb.stats().dropped, 2);
+}
+
+BOOST_AUTO_TEST_CASE(budgetFlushesBuffer)
+{
+  {
+    auto influxdb = InfluxDBFactory::Get("memory://budget?capacity=100");
+    influxdb->batchOf(1000);
+    influxdb->memoryBudget(point().size() * 10, Backpressure::Drop);
+    for (int i = 0; i < 100; i++) {
+      influxdb->write(point());
+    }
+    BOOST_CHECK_EQUAL(influxdb->stats().dropped, 0);
+  }
+  auto batches = transports::Memory::Drain("budget");
+  BOOST_CHECK_EQUAL(batches.size(), 10);
+  transports::Memory::Release("budget");
+}
+
+BOOST_AUTO_TEST_CASE(tryWriteKeepsBuffer)
+{
+  auto gated = new Gated;
+  InfluxDB influxdb{std::unique_ptr<Transport>(gated)};
+  influxdb.batchOf(100);
+  influxdb.memoryBudget(point().size() * 3, Backpressure::Drop);
+  for (int i = 0; i < 3; i++) {
+    BOOST_CHECK(influxdb.tryWrite(point()));
+  }
+  // flushing the full buffer would hang on the stalled transport
+  auto rejected = std::async(std::launch::async, [&] { return influxdb.tryWrite(point()); });
+  bool prompt = rejected.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+  gated->open();
+  BOOST_CHECK(prompt);
+  BOOST_CHECK(!rejected.get());
+  BOOST_CHECK_EQUAL(influxdb.stats().dropped, 1);
+  BOOST_CHECK_EQUAL(influxdb.stats().written, 3);
+}
+
+BOOST_AUTO_TEST_CASE(sampleDown)
+{
+  auto influxdb = InfluxDBFactory::Get("null://");
+  influxdb->batchOf(1000);
+  influxdb->memoryBudget(point().size() * 100, Backpressure::Sample);
+  for (int i = 0; i < 1000; i++) {
+    influxdb->tryWrite(point());
+  }
+  auto stats = influxdb->stats();
+  BOOST_CHECK(stats.sampledOut > 0);
+  BOOST_CHECK_EQUAL(stats.written + stats.sampledOut + stats.dropped, 1000);
+  BOOST_CHECK(stats.pendingBytes <= point().size() * 100);
+}
+
+} // namespace test
+} // namespace influxdb
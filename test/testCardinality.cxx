@@ -0,0 +1,76 @@
+#define BOOST_TEST_MODULE Test InfluxDB Cardinality
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDB.h"
+#include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
+#include "../src/HyperLogLog.h"
+
+#include <string>
+
+namespace influxdb {
+namespace test {
+
+BOOST_AUTO_TEST_CASE(hyperLogLogError)
+{
+  for (std::size_t count : {10, 1000, 100000}) {
+    HyperLogLog counter;
+    for (std::size_t i = 0; i < count; i++) {
+      counter.add(hash64("series" + std::to_string(i)));
+      counter.add(hash64("series" + std::to_string(i)));
+    }
+    BOOST_CHECK_CLOSE(counter.estimate(), count, 10.0);
+  }
+}
+
+Point request(int i)
+{
+  return Point{"api"}.addTag("host", "h" + std::to_string(i % 4)).addTag("request", std::to_string(i))
+    .addField("value", i);
+}
+
+BOOST_AUTO_TEST_CASE(rewriteOffendingTag)
+{
+  auto influxdb = InfluxDBFactory::Get("memory://cardinality?capacity=2000");
+  influxdb->cardinalityLimit(100);
+  for (int i = 0; i < 1000; i++) {
+    influxdb->write(request(i));
+  }
+  influxdb->write(Point{"other"}.addTag("request", "1").addField("value", 1));
+  auto lines = transports::Memory::Drain("cardinality");
+  BOOST_REQUIRE_EQUAL(lines.size(), 1001);
+  BOOST_CHECK_EQUAL(lines[0].substr(0, lines[0].find(' ')), "api,host=h0,request=0");
+  BOOST_CHECK_EQUAL(lines[999].substr(0, lines[999].find(' ')), "api,host=h3,request=_overflow");
+  BOOST_CHECK_EQUAL(lines[1000].substr(0, lines[1000].find(' ')), "other,request=1");
+
+  auto limited = influxdb->stats().limited;
+  BOOST_CHECK(limited > 850 && limited < 950);
+  BOOST_CHECK_CLOSE(static_cast<double>(influxdb->seriesCardinality("api")), 1000.0, 10.0);
+  BOOST_CHECK_EQUAL(influxdb->seriesCardinality("missing"), 0);
+  transports::Memory::Release("cardinality");
+}
+
+BOOST_AUTO_TEST_CASE(dropAndSample)
+{
+  auto influxdb = InfluxDBFactory::Get("null://");
+  influxdb->cardinalityLimit(100, CardinalityPolicy::Drop);
+  std::size_t rejected = 0;
+  for (int i = 0; i < 1000; i++) {
+    rejected += !influxdb->tryWrite(request(i));
+  }
+  BOOST_CHECK_EQUAL(influxdb->stats().limited, rejected);
+  BOOST_CHECK(rejected > 850 && rejected < 950);
+  // points without the offending tag pass
+  BOOST_CHECK(influxdb->tryWrite(Point{"api"}.addTag("host", "h1").addField("value", 1)));
+
+  influxdb->cardinalityLimit(100, CardinalityPolicy::Sample);
+  std::size_t kept = 0;
+  for (int i = 0; i < 1000; i++) {
+    kept += influxdb->tryWrite(request(i));
+  }
+  BOOST_CHECK(kept > 100 && kept < 200);
+}
+
+} // namespace test
+} // namespace influxdb
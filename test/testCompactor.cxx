@@ -0,0 +1,78 @@
+#define BOOST_TEST_MODULE Test InfluxDB Compactor
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDB.h"
+#include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
+#include "../src/Compactor.h"
+
+namespace influxdb {
+namespace test {
+
+BOOST_AUTO_TEST_CASE(groupBySeriesAndTime)
+{
+  std::string lines =
+    "cpu,host=b value=1 20\n"
+    "mem,host=a value=2 10\n"
+    "cpu,host=a value=3 20\n"
+    "cpu,host=b value=4 10\n";
+  BOOST_CHECK_EQUAL(Compactor::Compact(lines), 0);
+  BOOST_CHECK_EQUAL(lines,
+    "cpu,host=a value=3 20\n"
+    "cpu,host=b value=4 10\n"
+    "cpu,host=b value=1 20\n"
+    "mem,host=a value=2 10\n");
+}
+
+BOOST_AUTO_TEST_CASE(lastWriteWins)
+{
+  std::string lines =
+    "cpu,host=a value=1,idle=5i 10\n"
+    "cpu,host=b value=2 10\n"
+    "cpu,host=a value=3,text=\"a b\" 10\n"
+    "cpu,host=a value=4 11\n"
+    "cpu,host=a idle=6i 10\n";
+  BOOST_CHECK_EQUAL(Compactor::Compact(lines), 2);
+  BOOST_CHECK_EQUAL(lines,
+    "cpu,host=a value=3,idle=6i,text=\"a b\" 10\n"
+    "cpu,host=a value=4 11\n"
+    "cpu,host=b value=2 10\n");
+}
+
+BOOST_AUTO_TEST_CASE(withoutTimestamps)
+{
+  std::string lines = "cpu value=1\ncpu value=2 5\ncpu value=3\n";
+  BOOST_CHECK_EQUAL(Compactor::Compact(lines), 1);
+  BOOST_CHECK_EQUAL(lines, "cpu value=3\ncpu value=2 5\n");
+}
+
+BOOST_AUTO_TEST_CASE(malformedLeftUntouched)
+{
+  std::string lines = "cpu value=1 5\ncpu\ncpu value=2 5\n";
+  BOOST_CHECK_EQUAL(Compactor::Compact(lines), 0);
+  BOOST_CHECK_EQUAL(lines, "cpu value=1 5\ncpu\ncpu value=2 5\n");
+}
+
+BOOST_AUTO_TEST_CASE(flushStats)
+{
+  auto influxdb = InfluxDBFactory::Get("memory://compaction");
+  influxdb->batchOf(4);
+  influxdb->compactBatches();
+  std::chrono::time_point<std::chrono::system_clock> timestamp{};
+  influxdb->write(Point{"cpu"}.addTag("host", "a").addField("value", 1).setTimestamp(timestamp));
+  influxdb->write(Point{"mem"}.addTag("host", "a").addField("value", 2).setTimestamp(timestamp));
+  influxdb->write(Point{"cpu"}.addTag("host", "a").addField("value", 3).setTimestamp(timestamp));
+  influxdb->write(Point{"cpu"}.addTag("host", "a").addField("value", 4).setTimestamp(timestamp));
+  auto messages = transports::Memory::Drain("compaction");
+  BOOST_REQUIRE_EQUAL(messages.size(), 1);
+  BOOST_CHECK_EQUAL(messages[0], "cpu,host=a value=4i 0\nmem,host=a value=2i 0\n");
+  auto stats = influxdb->stats();
+  BOOST_CHECK_EQUAL(stats.written, 4);
+  BOOST_CHECK_EQUAL(stats.compacted, 2);
+  BOOST_CHECK_EQUAL(stats.compactedBytes, 2 * std::string("cpu,host=a value=1i 0\n").size());
+  transports::Memory::Release("compaction");
+}
+
+} // namespace test
+} // namespace influxdb
@@ -0,0 +1,223 @@
+#define BOOST_TEST_MODULE Test InfluxDB Coroutine
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/Coroutine.h"
+#include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
+#include "../src/InfluxDBException.h"
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace influxdb {
+namespace test {
+
+/// Completes every request from its own thread after a delay, like a transport with an event loop
+class Delayed : public Transport
+{
+  public:
+    ~Delayed() {
+      std::lock_guard<std::mutex> lock(mMutex);
+      for (auto& thread : mThreads) thread.join();
+    }
+    void send(std::string&&) override {
+      throw std::runtime_error("Blocking send");
+    }
+    void sendAsync(std::string&& message, SendHandler handler) override {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mThreads.emplace_back([this, message = std::move(message), handler] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        bool failing = message.rfind("failing", 0) == 0;
+        if (!failing) sent = message;
+        handler(failing ? std::make_exception_ptr(std::runtime_error("Unavailable")) : nullptr);
+      });
+    }
+    void queryAsync(const std::string& query, QueryHandler handler) override {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mThreads.emplace_back([query, handler] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (query == "SELECT * FROM missing") {
+          handler(R"({"results":[{"statement_id":0,"error":"measurement not found"}]})", nullptr);
+          return;
+        }
+        handler(R"({"results":[{"statement_id":0,"series":[{"name":"cpu","columns":["time","value"],)"
+          R"("values":[[1,10],[2,20],[3,30]]}]}]})", nullptr);
+      });
+    }
+    void queryChunked(const std::string& query, std::size_t chunkSize, ChunkHandler handler) override {
+      if (query != "SELECT * FROM stream") {
+        Transport::queryChunked(query, chunkSize, std::move(handler));
+        return;
+      }
+      std::lock_guard<std::mutex> lock(mMutex);
+      mThreads.emplace_back([this, handler] {
+        handler(R"({"results":[{"statement_id":0,"series":[{"name":"cpu","columns":["time","value"],)"
+          R"("values":[[1,10],[2,20]],"partial":true}],"partial":true}]})", false, nullptr);
+        // last chunk is held until the consumer got the first points
+        for (int i = 0; i < 500 && !consumed; i++) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        lastSent = true;
+        handler(R"({"results":[{"statement_id":0,"series":[{"name":"cpu","columns":["time","value"],)"
+          R"("values":[[3,30]]}]}]})", true, nullptr);
+      });
+    }
+    std::string sent;
+    std::atomic<bool> consumed{false};
+    std::atomic<bool> lastSent{false};
+  private:
+    std::mutex mMutex;
+    std::vector<std::thread> mThreads;
+};
+
+/// Eagerly started coroutine, completion observed through a future
+struct Task
+{
+  struct promise_type
+  {
+    std::promise<void> done;
+    Task get_return_object() { return Task{done.get_future()}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() { done.set_value(); }
+    void unhandled_exception() { done.set_exception(std::current_exception()); }
+  };
+  std::future<void> done;
+};
+
+Task queryPoints(InfluxDB& influxdb, std::vector<Point>& points, std::thread::id& resumedOn)
+{
+  points = co_await coro::query(influxdb, "SELECT * FROM cpu");
+  resumedOn = std::this_thread::get_id();
+}
+
+BOOST_AUTO_TEST_CASE(query)
+{
+  InfluxDB influxdb{std::make_unique<Delayed>()};
+  std::vector<Point> points;
+  std::thread::id resumedOn;
+  auto task = queryPoints(influxdb, points, resumedOn);
+  // suspended without blocking the caller
+  BOOST_CHECK(task.done.wait_for(std::chrono::seconds(0)) == std::future_status::timeout);
+  task.done.get();
+  BOOST_REQUIRE_EQUAL(points.size(), 3);
+  BOOST_CHECK_EQUAL(points[2].getFields(), "value=30");
+  BOOST_CHECK(resumedOn != std::this_thread::get_id());
+}
+
+Task queryMissing(InfluxDB& influxdb)
+{
+  co_await coro::query(influxdb, "SELECT * FROM missing");
+}
+
+BOOST_AUTO_TEST_CASE(queryError)
+{
+  InfluxDB influxdb{std::make_unique<Delayed>()};
+  BOOST_CHECK_THROW(queryMissing(influxdb).done.get(), InfluxDBException);
+}
+
+Task writePoints(InfluxDB& influxdb)
+{
+  std::vector<Point> points;
+  points.push_back(Point{"test"}.addField("value", 1).setTimestamp(std::chrono::time_point<std::chrono::system_clock>{}));
+  points.push_back(Point{"test"}.addField("value", 2).setTimestamp(std::chrono::time_point<std::chrono::system_clock>{}));
+  co_await coro::write(influxdb, std::move(points));
+  // nothing to transmit
+  co_await coro::write(influxdb, std::vector<Point>{});
+  std::vector<Point> failing;
+  failing.push_back(Point{"failing"}.addField("value", 3));
+  co_await coro::write(influxdb, std::move(failing));
+}
+
+BOOST_AUTO_TEST_CASE(write)
+{
+  auto delayed = new Delayed;
+  InfluxDB influxdb{std::unique_ptr<Transport>(delayed)};
+  BOOST_CHECK_THROW(writePoints(influxdb).done.get(), std::runtime_error);
+  BOOST_CHECK_EQUAL(delayed->sent, "test value=1i 0\ntest value=2i 0\n");
+}
+
+Task writeSynchronously(InfluxDB& influxdb)
+{
+  // transport without asynchronous support completes before suspending
+  co_await coro::write(influxdb, Point{"test"}.addField("value", 1));
+}
+
+BOOST_AUTO_TEST_CASE(writeAsyncAdmission)
+{
+  auto delayed = new Delayed;
+  InfluxDB influxdb{std::unique_ptr<Transport>(delayed)};
+  auto point = [](int value) {
+    return Point{"test"}.addField("value", value).setTimestamp(std::chrono::time_point<std::chrono::system_clock>{});
+  };
+  // budget fits a single point
+  influxdb.memoryBudget(point(1).size(), Backpressure::Block);
+  std::vector<Point> points;
+  points.push_back(point(1));
+  points.push_back(point(2));
+  std::promise<std::exception_ptr> done;
+  influxdb.writeAsync(std::move(points), [&done](std::exception_ptr error) { done.set_value(error); });
+  BOOST_CHECK(done.get_future().get() == nullptr);
+  auto stats = influxdb.stats();
+  BOOST_CHECK_EQUAL(stats.written, 1);
+  BOOST_CHECK_EQUAL(stats.dropped, 1);
+  BOOST_CHECK_EQUAL(stats.pendingBytes, 0);
+  BOOST_CHECK_EQUAL(delayed->sent, "test value=1i 0\n");
+}
+
+BOOST_AUTO_TEST_CASE(writeWithoutAsyncTransport)
+{
+  auto influxdb = InfluxDBFactory::Get("memory://coroutine");
+  auto task = writeSynchronously(*influxdb);
+  BOOST_CHECK(task.done.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+  BOOST_CHECK_EQUAL(transports::Memory::Drain("coroutine").size(), 1);
+  transports::Memory::Release("coroutine");
+}
+
+Task sumRows(InfluxDB& influxdb, long long& sum, int& count)
+{
+  auto rows = coro::rows(influxdb, "SELECT * FROM cpu");
+  while (auto point = co_await rows.next()) {
+    sum += std::stoll(point->getFields().substr(std::string("value=").size()));
+    count++;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(generator)
+{
+  InfluxDB influxdb{std::make_unique<Delayed>()};
+  long long sum = 0;
+  int count = 0;
+  sumRows(influxdb, sum, count).done.get();
+  BOOST_CHECK_EQUAL(count, 3);
+  BOOST_CHECK_EQUAL(sum, 60);
+}
+
+Task streamRows(InfluxDB& influxdb, Delayed& delayed, bool& streamed, int& count)
+{
+  auto rows = coro::rows(influxdb, "SELECT * FROM stream");
+  while (auto point = co_await rows.next()) {
+    if (count++ == 0) {
+      streamed = !delayed.lastSent;
+      delayed.consumed = true;
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(streamedGenerator)
+{
+  auto delayed = new Delayed;
+  InfluxDB influxdb{std::unique_ptr<Transport>(delayed)};
+  bool streamed = false;
+  int count = 0;
+  streamRows(influxdb, *delayed, streamed, count).done.get();
+  // first points were yielded before the rest of the response arrived
+  BOOST_CHECK(streamed);
+  BOOST_CHECK_EQUAL(count, 3);
+}
+
+} // namespace test
+} // namespace influxdb
@@ -3,6 +3,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
 #include "../src/InfluxDBException.h"
 
 namespace influxdb {
@@ -24,5 +25,38 @@ BOOST_AUTO_TEST_CASE(missingDb)
   BOOST_CHECK_THROW(influxdb::InfluxDBFactory::Get("http://localhost:8086"), InfluxDBException);
 }
 
+BOOST_AUTO_TEST_CASE(version2Bucket)
+{
+  BOOST_CHECK_NO_THROW(influxdb::InfluxDBFactory::Get("http://localhost:8086?org=test&bucket=test&token=secret"));
+  BOOST_CHECK_THROW(influxdb::InfluxDBFactory::Get("http://localhost:8086?org=test&token=secret"), InfluxDBException);
+}
+
+BOOST_AUTO_TEST_CASE(precision)
+{
+  BOOST_CHECK_NO_THROW(influxdb::InfluxDBFactory::Get("http://localhost:8086?db=test&precision=ms"));
+  BOOST_CHECK_THROW(influxdb::InfluxDBFactory::Get("http://localhost:8086?db=test&precision=d"), InfluxDBException);
+}
+
+BOOST_AUTO_TEST_CASE(precisionOfComposites)
+{
+  {
+    auto influxdb = influxdb::InfluxDBFactory::GetReplicated({"memory://precision0?precision=s",
+      "memory://precision1?precision=s"});
+    influxdb->write(Point{"test"}.addField("value", 10));
+  }
+  auto lines = transports::Memory::Drain("precision0");
+  BOOST_REQUIRE_EQUAL(lines.size(), 1);
+  // seconds since epoch have 10 digits
+  BOOST_CHECK_EQUAL(lines[0].size() - lines[0].rfind(' ') - 1, 10);
+  transports::Memory::Release("precision0");
+  transports::Memory::Release("precision1");
+
+  BOOST_CHECK_THROW(influxdb::InfluxDBFactory::GetSharded({"memory://precision2?precision=s",
+    "memory://precision3?precision=ms"}), InfluxDBException);
+  BOOST_CHECK_THROW(influxdb::InfluxDBFactory::GetSharded({"memory://precision2?precision=d"}), InfluxDBException);
+  transports::Memory::Release("precision2");
+  transports::Memory::Release("precision3");
+}
+
 } // namespace test
 } // namespace influxdb
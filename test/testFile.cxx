@@ -0,0 +1,175 @@
+#define BOOST_TEST_MODULE Test InfluxDB File
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
+#include "../src/File.h"
+#include "../src/InfluxDBException.h"
+
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <thread>
+
+namespace influxdb {
+namespace test {
+
+struct TemporaryDirectory
+{
+  TemporaryDirectory() {
+    std::string pattern = (std::filesystem::temp_directory_path() / "influxdb-cxx-XXXXXX").string();
+    path = mkdtemp(pattern.data());
+  }
+  ~TemporaryDirectory() { std::filesystem::remove_all(path); }
+  std::size_t count() const {
+    return std::distance(std::filesystem::directory_iterator(path), std::filesystem::directory_iterator());
+  }
+  std::filesystem::path path;
+};
+
+BOOST_AUTO_TEST_CASE(writeAndReplay)
+{
+  TemporaryDirectory directory;
+  auto file = (directory.path / "metrics.lp").string();
+  {
+    auto influxdb = influxdb::InfluxDBFactory::Get("file://" + file);
+    influxdb->batchOf(2);
+    for (int i = 0; i < 5; i++) {
+      influxdb->write(Point{"test"}.addField("value", i));
+    }
+  }
+  std::ifstream input(file);
+  std::string line;
+  int lines = 0;
+  while (std::getline(input, line)) {
+    BOOST_CHECK_EQUAL(line.substr(0, 10), "test value");
+    lines++;
+  }
+  BOOST_CHECK_EQUAL(lines, 5);
+
+  auto influxdb = influxdb::InfluxDBFactory::Get("memory://replay");
+  influxdb->replay(file, 64);
+  auto chunks = transports::Memory::Drain("replay");
+  BOOST_CHECK(chunks.size() > 1);
+  std::string replayed;
+  for (auto& chunk : chunks) {
+    BOOST_CHECK(chunk.size() <= 64);
+    BOOST_CHECK_EQUAL(chunk.back(), '\n');
+    replayed += chunk;
+  }
+  std::ifstream original(file);
+  BOOST_CHECK_EQUAL(replayed, std::string(std::istreambuf_iterator<char>(original), {}));
+  transports::Memory::Release("replay");
+}
+
+BOOST_AUTO_TEST_CASE(flushAndRotateWhenIdle)
+{
+  TemporaryDirectory directory;
+  auto file = (directory.path / "metrics.lp").string();
+  transports::File transport(file, 0, std::chrono::seconds(1), false, 1024, std::chrono::milliseconds(20));
+  transport.send("test value=1i");
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  // buffered line reaches the file without further writes
+  BOOST_CHECK_EQUAL(std::filesystem::file_size(file), 14);
+  BOOST_CHECK_EQUAL(directory.count(), 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  // aged segment rotated without further writes
+  BOOST_CHECK_EQUAL(directory.count(), 2);
+  BOOST_CHECK_EQUAL(std::filesystem::file_size(file), 0);
+}
+
+BOOST_AUTO_TEST_CASE(writeAsyncWithBatches)
+{
+  TemporaryDirectory directory;
+  auto file = (directory.path / "metrics.lp").string();
+  {
+    // small buffer so that sends reach the file while the other thread sends as well
+    auto influxdb = influxdb::InfluxDBFactory::Get("file://" + file + "?bufferSize=64");
+    influxdb->batchOf(10);
+    std::thread writer([&influxdb] {
+      for (int i = 0; i < 2000; i++) {
+        influxdb->write(Point{"batched"}.addField("value", i));
+      }
+    });
+    for (int i = 0; i < 200; i++) {
+      std::vector<Point> points;
+      for (int j = 0; j < 10; j++) {
+        points.push_back(Point{"async"}.addField("value", i * 10 + j));
+      }
+      std::promise<std::exception_ptr> done;
+      influxdb->writeAsync(std::move(points), [&done](std::exception_ptr error) { done.set_value(error); });
+      BOOST_CHECK(done.get_future().get() == nullptr);
+    }
+    writer.join();
+  }
+  std::ifstream input(file);
+  std::string line;
+  int batched = 0, async = 0;
+  while (std::getline(input, line)) {
+    if (line.rfind("batched value=", 0) == 0) batched++;
+    else if (line.rfind("async value=", 0) == 0) async++;
+    else BOOST_ERROR("Corrupted line: " + line);
+  }
+  BOOST_CHECK_EQUAL(batched, 2000);
+  BOOST_CHECK_EQUAL(async, 2000);
+}
+
+BOOST_AUTO_TEST_CASE(rotateBySize)
+{
+  TemporaryDirectory directory;
+  auto file = (directory.path / "metrics.lp").string();
+  {
+    transports::File transport(file, 10, std::chrono::seconds(0), false, 4);
+    transport.send("test value=1i");
+    transport.send("test value=2i");
+    transport.send("test");
+  }
+  BOOST_CHECK_EQUAL(directory.count(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(compressAndReplay)
+{
+  TemporaryDirectory directory;
+  auto file = (directory.path / "metrics.lp").string();
+  try {
+    transports::File transport(file, 1, std::chrono::seconds(0), true);
+    transport.send("test value=1i");
+  } catch (const InfluxDBException&) {
+    BOOST_TEST_MESSAGE("Built without zlib, skipping");
+    return;
+  }
+  BOOST_REQUIRE_EQUAL(directory.count(), 2);
+  int compressed = 0;
+  for (auto& entry : std::filesystem::directory_iterator(directory.path)) {
+    if (entry.path().extension() != ".gz") continue;
+    std::string replayed;
+    transports::File::Replay(entry.path().string(), [&replayed](std::string&& chunk) { replayed += chunk; });
+    BOOST_CHECK_EQUAL(replayed, "test value=1i\n");
+    compressed++;
+  }
+  BOOST_CHECK_EQUAL(compressed, 1);
+}
+
+BOOST_AUTO_TEST_CASE(compressionFailureKeepsSegment)
+{
+  TemporaryDirectory directory;
+  auto segment = (directory.path / "metrics.lp.1").string();
+  std::ofstream(segment) << "test value=1i\n";
+  // output path taken by a directory
+  std::filesystem::create_directory(segment + ".gz");
+  BOOST_CHECK(!transports::File::Compress(segment));
+  BOOST_CHECK(std::filesystem::exists(segment));
+  std::string replayed;
+  transports::File::Replay(segment, [&replayed](std::string&& chunk) { replayed += chunk; });
+  BOOST_CHECK_EQUAL(replayed, "test value=1i\n");
+}
+
+BOOST_AUTO_TEST_CASE(missingFile)
+{
+  BOOST_CHECK_THROW(transports::File::Replay("/nonexistent/metrics.lp", [](std::string&&) {}), InfluxDBException);
+  BOOST_CHECK_THROW(influxdb::InfluxDBFactory::Get("file:///nonexistent/metrics.lp"), InfluxDBException);
+}
+
+} // namespace test
+} // namespace influxdb
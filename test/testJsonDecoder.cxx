@@ -0,0 +1,125 @@
+#define BOOST_TEST_MODULE Test InfluxDB JSON decoder
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../src/JsonDecoder.h"
+#include "../src/InfluxDBException.h"
+
+namespace influxdb {
+namespace test {
+
+std::vector<std::vector<Point>> decode(const std::string& json)
+{
+  ResultBuilder builder(Precision::Nanoseconds);
+  JsonDecoder::Decode(json, builder);
+  return builder.results();
+}
+
+BOOST_AUTO_TEST_CASE(typedValues)
+{
+  auto results = decode(R"({"results":[{"statement_id":0,"series":[{"name":"test",
+    "columns":["time","host","int","float","bool","empty"],
+    "values":[[1572830914000000000,"localhost",10,10.5,true,null],[1572830915000000000,"remote",-1,1e3,false,null]]}]}]})");
+  BOOST_REQUIRE_EQUAL(results.size(), 1);
+  auto& points = results[0];
+  BOOST_REQUIRE_EQUAL(points.size(), 2);
+  BOOST_CHECK_EQUAL(points[0].getName(), "test");
+  // tag keys unknown: string columns are fields
+  BOOST_CHECK_EQUAL(points[0].getTags(), "");
+  BOOST_CHECK_EQUAL(points[0].getFields(), "host=\"localhost\",int=10,float=10.5,bool=true");
+  BOOST_CHECK_EQUAL(points[1].getFields(), "host=\"remote\",int=-1,float=1000,bool=false");
+  BOOST_CHECK_EQUAL(std::chrono::duration_cast<std::chrono::seconds>(points[1].getTimestamp().time_since_epoch()).count(), 1572830915);
+}
+
+BOOST_AUTO_TEST_CASE(tagKeys)
+{
+  std::string json = R"({"results":[{"statement_id":0,"series":[{"name":"test","columns":["time","host","message"],
+    "values":[[1,"localhost","up"]]}]}]})";
+  TagKeys tagKeys;
+  ResultBuilder unknown(Precision::Nanoseconds, &tagKeys);
+  JsonDecoder::Decode(json, unknown);
+  BOOST_CHECK(unknown.unresolved() == std::set<std::string>{"test"});
+  BOOST_CHECK_EQUAL(TagKeys::Query(unknown.unresolved()), "SHOW TAG KEYS FROM \"test\"");
+  BOOST_CHECK_EQUAL(TagKeys::Query({"a\"b", "c"}), "SHOW TAG KEYS FROM \"a\\\"b\",\"c\"");
+
+  ResultBuilder keys(Precision::Nanoseconds);
+  JsonDecoder::Decode(R"({"results":[{"statement_id":0,"series":[{"name":"test","columns":["tagKey"],
+    "values":[["host"],["dc"]]}]}]})", keys);
+  tagKeys.update({"test", "other"}, keys.results().at(0));
+  BOOST_CHECK_EQUAL(tagKeys.find("test")->size(), 2);
+  BOOST_CHECK_EQUAL(tagKeys.find("other")->size(), 0);
+  BOOST_CHECK(!tagKeys.find("missing"));
+
+  ResultBuilder resolved(Precision::Nanoseconds, &tagKeys);
+  JsonDecoder::Decode(json, resolved);
+  BOOST_CHECK(resolved.unresolved().empty());
+  auto points = resolved.results().at(0);
+  BOOST_CHECK_EQUAL(points.at(0).getTags(), "host=localhost");
+  BOOST_CHECK_EQUAL(points.at(0).getFields(), "message=\"up\"");
+}
+
+BOOST_AUTO_TEST_CASE(groupByTags)
+{
+  auto results = decode(R"({"results":[{"statement_id":0,"series":[
+    {"name":"test","tags":{"host":"a"},"columns":["time","message"],"values":[["2019-11-04T01:28:34Z","x\"yé"]]},
+    {"name":"test","tags":{"host":"b"},"columns":["time","message"],"values":[["2019-11-04T01:28:35Z","z"]]}]}]})");
+  auto& points = results.at(0);
+  BOOST_REQUIRE_EQUAL(points.size(), 2);
+  BOOST_CHECK_EQUAL(points[0].getTags(), "host=a");
+  BOOST_CHECK_EQUAL(points[0].getFields(), "message=\"x\\\"y\xc3\xa9\"");
+  BOOST_CHECK_EQUAL(points[1].getTags(), "host=b");
+  BOOST_CHECK_EQUAL(points[1].getFields(), "message=\"z\"");
+}
+
+BOOST_AUTO_TEST_CASE(multipleStatements)
+{
+  auto results = decode(R"({"results":[{"statement_id":1,"series":[{"name":"b","columns":["time","v"],"values":[[1,2]]}]},
+    {"statement_id":0},{"statement_id":2,"series":[{"name":"c","columns":["time","v"],"values":[[1,2],[2,3]]}]}]})");
+  BOOST_REQUIRE_EQUAL(results.size(), 3);
+  BOOST_CHECK_EQUAL(results[0].size(), 0);
+  BOOST_CHECK_EQUAL(results[1].at(0).getName(), "b");
+  BOOST_CHECK_EQUAL(results[2].size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(demultiplexStatements)
+{
+  ResultBuilder builder(Precision::Nanoseconds);
+  JsonDecoder::Decode(R"({"results":[{"statement_id":2,"series":[{"name":"c","columns":["time","v"],"values":[[1,2]]}]},
+    {"statement_id":0,"series":[{"name":"a","columns":["time","v"],"values":[[1,2]]}]}]})", builder);
+  auto results = builder.results(4);
+  BOOST_REQUIRE_EQUAL(results.size(), 4);
+  BOOST_CHECK_EQUAL(results[0].points.at(0).getName(), "a");
+  BOOST_CHECK_EQUAL(results[1].points.size(), 0);
+  BOOST_CHECK_EQUAL(results[2].points.at(0).getName(), "c");
+  BOOST_CHECK_EQUAL(results[3].points.size(), 0);
+
+  JsonDecoder::Decode(R"({"results":[{"statement_id":3}]})", builder);
+  BOOST_CHECK_THROW(builder.results(2), InfluxDBException);
+}
+
+BOOST_AUTO_TEST_CASE(statementErrors)
+{
+  ResultBuilder builder(Precision::Nanoseconds);
+  JsonDecoder::Decode(R"({"results":[{"statement_id":0,"series":[{"name":"a","columns":["time","v"],"values":[[1,2]]}]},
+    {"statement_id":1,"error":"measurement not found"},
+    {"statement_id":2,"series":[{"name":"c","columns":["time","v"],"values":[[1,2]]}]}]})", builder);
+  auto results = builder.results(3);
+  BOOST_REQUIRE_EQUAL(results.size(), 3);
+  BOOST_CHECK_EQUAL(results[0].points.at(0).getName(), "a");
+  BOOST_CHECK(results[0].error.empty());
+  BOOST_CHECK_EQUAL(results[1].points.size(), 0);
+  BOOST_CHECK_EQUAL(results[1].error, "measurement not found");
+  BOOST_CHECK_EQUAL(results[2].points.at(0).getName(), "c");
+  BOOST_CHECK(results[2].error.empty());
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+  BOOST_CHECK_THROW(decode(R"({"results":[{"statement_id":0,"error":"database not found: test"}]})"), InfluxDBException);
+  BOOST_CHECK_THROW(decode(R"({"error":"error parsing query"})"), InfluxDBException);
+  BOOST_CHECK_THROW(decode(R"({"results":[{"statement_id":0,"series":[)"), InfluxDBException);
+  BOOST_CHECK_EQUAL(decode(R"({"results":[{"statement_id":0}]})").at(0).size(), 0);
+}
+
+} // namespace test
+} // namespace influxdb
@@ -0,0 +1,112 @@
+#define BOOST_TEST_MODULE Test InfluxDB Line Protocol Parser
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/LineProtocolParser.h"
+#include "../include/InfluxDBFactory.h"
+#include "../src/InfluxDBException.h"
+
+#include <cstdio>
+
+namespace influxdb {
+namespace test {
+
+using Parser = LineProtocolParser;
+
+BOOST_AUTO_TEST_CASE(typedFields)
+{
+  std::string data = "cpu,host=a,region=eu-west value=1.5,count=10i,total=20u,up=true,down=F,"
+    "message=\"a, b=\\\"c\\\" d\" 1572830914000000000\n";
+  Parser parser(data);
+  Parser::Record record;
+  BOOST_REQUIRE(parser.next(record));
+  BOOST_CHECK_EQUAL(record.measurement, "cpu");
+  BOOST_REQUIRE_EQUAL(record.tags.size(), 2);
+  BOOST_CHECK_EQUAL(record.tags[1].key, "region");
+  BOOST_CHECK_EQUAL(record.tags[1].value, "eu-west");
+  BOOST_REQUIRE_EQUAL(record.fields.size(), 6);
+  BOOST_CHECK(record.fields[0].type == Parser::FieldType::Float);
+  BOOST_CHECK_EQUAL(record.fields[0].floatValue, 1.5);
+  BOOST_CHECK(record.fields[1].type == Parser::FieldType::Integer);
+  BOOST_CHECK_EQUAL(record.fields[1].integerValue, 10);
+  BOOST_CHECK(record.fields[2].type == Parser::FieldType::Unsigned);
+  BOOST_CHECK_EQUAL(record.fields[2].unsignedValue, 20);
+  BOOST_CHECK(record.fields[3].booleanValue);
+  BOOST_CHECK(!record.fields[4].booleanValue);
+  BOOST_CHECK(record.fields[5].type == Parser::FieldType::String);
+  BOOST_CHECK_EQUAL(Parser::Unescape(record.fields[5].string), "a, b=\"c\" d");
+  BOOST_CHECK(record.hasTimestamp);
+  BOOST_CHECK_EQUAL(record.timestamp, 1572830914000000000LL);
+  BOOST_CHECK_EQUAL(record.line, data.substr(0, data.size() - 1));
+  BOOST_CHECK(!parser.next(record));
+}
+
+BOOST_AUTO_TEST_CASE(escapesCommentsAndBlankLines)
+{
+  std::string data = "# comment\r\n\r\n  my\\ measurement,tag\\,key=tag\\ value field\\=key=-2i\r\n"
+    "no_timestamp value=3";
+  Parser parser(data);
+  Parser::Record record;
+  BOOST_REQUIRE(parser.next(record));
+  BOOST_CHECK_EQUAL(parser.lineNumber(), 3);
+  BOOST_CHECK_EQUAL(Parser::Unescape(record.measurement), "my measurement");
+  BOOST_CHECK_EQUAL(Parser::Unescape(record.tags[0].key), "tag,key");
+  BOOST_CHECK_EQUAL(Parser::Unescape(record.tags[0].value), "tag value");
+  BOOST_CHECK_EQUAL(Parser::Unescape(record.fields[0].key), "field=key");
+  BOOST_CHECK_EQUAL(record.fields[0].integerValue, -2);
+  BOOST_CHECK(!record.hasTimestamp);
+  BOOST_REQUIRE(parser.next(record));
+  BOOST_CHECK_EQUAL(record.measurement, "no_timestamp");
+  BOOST_CHECK_EQUAL(record.fields[0].floatValue, 3);
+  BOOST_CHECK(!parser.next(record));
+}
+
+BOOST_AUTO_TEST_CASE(malformed)
+{
+  for (std::string line : {"measurement", "m,tag value=1", "m,=x value=1", "m value", "m value=", "m value=1x",
+    "m value=10.5i", "m value=\"open", "m value=\"abc\\", "m value=\"abc\\\\", "m value=1 12a", "m value=1\"",
+    ",tag=x value=1"}) {
+    Parser parser(line);
+    Parser::Record record;
+    BOOST_CHECK_THROW(parser.next(record), InfluxDBException);
+  }
+  // parsing continues after a malformed line
+  Parser parser("m value=x\nm value=1\n");
+  Parser::Record record;
+  BOOST_CHECK_THROW(parser.next(record), InfluxDBException);
+  BOOST_REQUIRE(parser.next(record));
+  BOOST_CHECK_EQUAL(parser.lineNumber(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(mappedFileRoundTrip)
+{
+  std::string path = "/tmp/influxdb-cxx-test-parser.lp";
+  std::remove(path.c_str());
+  {
+    auto influxdb = InfluxDBFactory::Get("file://" + path);
+    influxdb->batchOf(100);
+    for (int i = 0; i < 1000; i++) {
+      influxdb->write(Point{"test"}.addTag("host", "localhost").addField("value", i)
+        .addField("text", "with \"quotes\", spaces and commas")
+        .setTimestamp(std::chrono::time_point<std::chrono::system_clock>(std::chrono::seconds(i))));
+    }
+  }
+  Parser::MappedFile file(path);
+  Parser parser(file.data());
+  Parser::Record record;
+  long long sum = 0;
+  int lines = 0;
+  while (parser.next(record)) {
+    BOOST_REQUIRE_EQUAL(record.fields.size(), 2);
+    sum += record.fields[0].integerValue;
+    BOOST_CHECK_EQUAL(record.timestamp, lines * 1000000000LL);
+    lines++;
+  }
+  BOOST_CHECK_EQUAL(lines, 1000);
+  BOOST_CHECK_EQUAL(sum, 999 * 1000 / 2);
+  BOOST_CHECK_EQUAL(Parser::Unescape(record.fields[1].string), "with \"quotes\", spaces and commas");
+  std::remove(path.c_str());
+}
+
+} // namespace test
+} // namespace influxdb
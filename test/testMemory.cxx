@@ -0,0 +1,71 @@
+#define BOOST_TEST_MODULE Test InfluxDB Memory
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
+#include "../src/InfluxDBException.h"
+
+namespace influxdb {
+namespace test {
+
+BOOST_AUTO_TEST_CASE(nullTransport)
+{
+  auto influxdb = influxdb::InfluxDBFactory::Get("null://");
+  influxdb->batchOf(2);
+  influxdb->write(Point{"test"}.addField("value", 10));
+  influxdb->write(Point{"test"}.addField("value", 20));
+  BOOST_CHECK_THROW(influxdb->query("SELECT * from test"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(memoryReadBack)
+{
+  {
+    auto influxdb = influxdb::InfluxDBFactory::Get("memory://readBack");
+    influxdb->write(Point{"test"}.addField("value", 10).addTag("host", "localhost"));
+    influxdb->write(Point{"test"}.addField("value", 20).addTag("host", "localhost"));
+  }
+  auto messages = transports::Memory::Read("readBack");
+  BOOST_CHECK_EQUAL(messages.size(), 2);
+  BOOST_CHECK_EQUAL(messages[0].substr(0, 29), "test,host=localhost value=10i");
+  BOOST_CHECK_EQUAL(messages[1].substr(0, 29), "test,host=localhost value=20i");
+
+  BOOST_CHECK_EQUAL(transports::Memory::Drain("readBack").size(), 2);
+  BOOST_CHECK_EQUAL(transports::Memory::Read("readBack").size(), 0);
+  transports::Memory::Release("readBack");
+  BOOST_CHECK_THROW(transports::Memory::Read("readBack"), InfluxDBException);
+}
+
+BOOST_AUTO_TEST_CASE(serverTimestamps)
+{
+  auto influxdb = influxdb::InfluxDBFactory::Get("memory://serverTimestamps");
+  influxdb->serverTimestamps();
+  influxdb->write(Point{"test"}.addField("value", 10));
+  BOOST_CHECK_EQUAL(transports::Memory::Read("serverTimestamps").at(0), "test value=10i");
+  transports::Memory::Release("serverTimestamps");
+}
+
+BOOST_AUTO_TEST_CASE(memoryOverwrite)
+{
+  transports::Memory memory("", 2);
+  memory.send("a");
+  memory.send("b");
+  memory.send("c");
+  auto messages = memory.read();
+  BOOST_CHECK_EQUAL(messages.size(), 2);
+  BOOST_CHECK_EQUAL(messages[0], "b");
+  BOOST_CHECK_EQUAL(messages[1], "c");
+  BOOST_CHECK_EQUAL(memory.dropped(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(memoryCapacity)
+{
+  auto influxdb = influxdb::InfluxDBFactory::Get("memory://capacity?capacity=1");
+  influxdb->write(Point{"test"}.addField("value", 10));
+  influxdb->write(Point{"test"}.addField("value", 20));
+  BOOST_CHECK_EQUAL(transports::Memory::Read("capacity").size(), 1);
+  transports::Memory::Release("capacity");
+}
+
+} // namespace test
+} // namespace influxdb
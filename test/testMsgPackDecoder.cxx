@@ -0,0 +1,118 @@
+#define BOOST_TEST_MODULE Test InfluxDB MessagePack decoder
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../src/MsgPackDecoder.h"
+#include "../src/InfluxDBException.h"
+
+#include <cstring>
+
+namespace influxdb {
+namespace test {
+
+/// Minimal MessagePack writer producing InfluxDB response layout
+struct Writer
+{
+  std::string data;
+
+  template<typename T>
+  Writer& big(T value) {
+    for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+      data += static_cast<char>((static_cast<std::uint64_t>(value) >> shift) & 0xff);
+    }
+    return *this;
+  }
+  Writer& map(std::uint8_t size) { data += static_cast<char>(0x80 | size); return *this; }
+  Writer& array(std::uint8_t size) { data += static_cast<char>(0x90 | size); return *this; }
+  Writer& str(const std::string& value) {
+    if (value.size() < 32) {
+      data += static_cast<char>(0xa0 | value.size());
+    } else {
+      data += '\xd9';
+      data += static_cast<char>(value.size());
+    }
+    data += value;
+    return *this;
+  }
+  Writer& integer(long long int value) { data += '\xd3'; return big(value); }
+  Writer& real(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    data += '\xcb';
+    return big(bits);
+  }
+  Writer& boolean(bool value) { data += value ? '\xc3' : '\xc2'; return *this; }
+  Writer& nil() { data += '\xc0'; return *this; }
+  Writer& time(std::int64_t seconds, std::int32_t nanoseconds) {
+    data += "\xc7\x0c\x05";
+    return big(seconds).big(nanoseconds);
+  }
+};
+
+std::vector<std::vector<Point>> decode(const std::string& data)
+{
+  ResultBuilder builder(Precision::Nanoseconds);
+  MsgPackDecoder::Decode(data, builder);
+  return builder.results();
+}
+
+BOOST_AUTO_TEST_CASE(typedValues)
+{
+  Writer writer;
+  writer.map(1).str("results").array(1)
+    .map(2).str("id").integer(0).str("series").array(1)
+      .map(3).str("name").str("test").str("columns").array(6)
+        .str("time").str("host").str("int").str("float").str("bool").str("none")
+      .str("values").array(2)
+        .array(6).integer(1572830914123456789LL).str("localhost").integer(-10).real(1.5).boolean(true).nil()
+        .array(6).time(1572830915, 5).str("remote").integer(20).real(2.5).boolean(false).nil();
+
+  BOOST_CHECK(MsgPackDecoder::Detect(writer.data));
+  BOOST_CHECK(!MsgPackDecoder::Detect(R"({"results":[]})"));
+  auto results = decode(writer.data);
+  BOOST_REQUIRE_EQUAL(results.size(), 1);
+  auto& points = results[0];
+  BOOST_REQUIRE_EQUAL(points.size(), 2);
+  BOOST_CHECK_EQUAL(points[0].getName(), "test");
+  BOOST_CHECK_EQUAL(points[0].getFields(), "host=\"localhost\",int=-10i,float=1.5,bool=true");
+  BOOST_CHECK_EQUAL(std::chrono::duration_cast<std::chrono::nanoseconds>(points[0].getTimestamp().time_since_epoch()).count(),
+    1572830914123456789LL);
+  BOOST_CHECK_EQUAL(points[1].getFields(), "host=\"remote\",int=20i,float=2.5,bool=false");
+  BOOST_CHECK_EQUAL(std::chrono::duration_cast<std::chrono::nanoseconds>(points[1].getTimestamp().time_since_epoch()).count(),
+    1572830915000000005LL);
+}
+
+BOOST_AUTO_TEST_CASE(multipleStatements)
+{
+  Writer writer;
+  writer.map(1).str("results").array(2)
+    .map(2).str("id").integer(1).str("series").array(1)
+      .map(4).str("name").str("cpu").str("tags").map(1).str("host").str("a")
+        .str("columns").array(2).str("time").str("path")
+        .str("values").array(1).array(2).integer(1).str("/api")
+    .map(2).str("id").integer(0).str("series").array(0);
+  ResultBuilder builder(Precision::Nanoseconds);
+  MsgPackDecoder::Decode(writer.data, builder);
+  auto results = builder.results(2);
+  BOOST_CHECK_EQUAL(results[0].points.size(), 0);
+  BOOST_REQUIRE_EQUAL(results[1].points.size(), 1);
+  // with tags metadata string columns are fields
+  BOOST_CHECK_EQUAL(results[1].points[0].getTags(), "host=a");
+  BOOST_CHECK_EQUAL(results[1].points[0].getFields(), "path=\"/api\"");
+}
+
+BOOST_AUTO_TEST_CASE(errors)
+{
+  Writer statementError;
+  statementError.map(1).str("results").array(1).map(2).str("id").integer(0).str("error").str("database not found: test");
+  BOOST_CHECK_THROW(decode(statementError.data), InfluxDBException);
+
+  Writer truncated;
+  truncated.map(1).str("results").array(1).map(2).str("id");
+  BOOST_CHECK_THROW(decode(truncated.data), InfluxDBException);
+
+  BOOST_CHECK_THROW(decode("\x81\xa7results\x05"), InfluxDBException);
+}
+
+} // namespace test
+} // namespace influxdb
@@ -1,8 +1,10 @@
 #define BOOST_TEST_MODULE Test InfluxDB Point
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
+#include <iterator>
 
 #include "../include/InfluxDBFactory.h"
+#include "../src/TimestampFormatter.h"
 
 namespace influxdb {
 namespace test {
@@ -62,5 +64,86 @@ BOOST_AUTO_TEST_CASE(test4)
   BOOST_CHECK_EQUAL(result[2], "1572830914000000");
 }
 
+BOOST_AUTO_TEST_CASE(fieldTypes)
+{
+  std::string text = "say \"hi\"";
+  auto point = Point{"test", TimestampSource::Server}
+    .addField("bool", true)
+    .addField("int", 10)
+    .addField("long", -10L)
+    .addField("uint", 10U)
+    .addField("ulong", 18446744073709551615ULL)
+    .addField("double", 0.5)
+    .addField("literal", "11")
+    .addField("string", text);
+
+  BOOST_CHECK_EQUAL(point.getFields(),
+    "bool=true,int=10i,long=-10i,uint=10u,ulong=18446744073709551615u,double=0.5,literal=\"11\",string=\"say \\\"hi\\\"\"");
+}
+
+BOOST_AUTO_TEST_CASE(precision)
+{
+  auto point = Point{"test"}
+    .addField("value", 10)
+    .setTimestamp(std::chrono::time_point<std::chrono::system_clock>(std::chrono::milliseconds(1572830914123)));
+
+  BOOST_CHECK_EQUAL(getVector(point)[2], "1572830914123000000");
+  std::istringstream seconds(point.toLineProtocol(Precision::Seconds));
+  std::istringstream milliseconds(point.toLineProtocol(Precision::Milliseconds));
+  std::istringstream microseconds(point.toLineProtocol(Precision::Microseconds));
+  std::string field;
+  seconds >> field >> field >> field;
+  BOOST_CHECK_EQUAL(field, "1572830914");
+  milliseconds >> field >> field >> field;
+  BOOST_CHECK_EQUAL(field, "1572830914123");
+  microseconds >> field >> field >> field;
+  BOOST_CHECK_EQUAL(field, "1572830914123000");
+}
+
+BOOST_AUTO_TEST_CASE(serverTimestamp)
+{
+  auto point = Point{"test", TimestampSource::Server}.addField("value", 10);
+  BOOST_CHECK(!point.hasTimestamp());
+  BOOST_CHECK_EQUAL(point.toLineProtocol(), "test value=10i");
+
+  point.setTimestamp(std::chrono::time_point<std::chrono::system_clock>(std::chrono::seconds(1)));
+  BOOST_CHECK_EQUAL(point.toLineProtocol(Precision::Seconds), "test value=10i 1");
+  BOOST_CHECK_EQUAL(point.removeTimestamp().toLineProtocol(), "test value=10i");
+}
+
+BOOST_AUTO_TEST_CASE(coarseTimestamp)
+{
+  auto before = std::chrono::system_clock::now();
+  auto point = Point{"test", TimestampSource::Coarse}.addField("value", 10);
+  BOOST_CHECK(point.hasTimestamp());
+  auto difference = point.getTimestamp() - before;
+  BOOST_CHECK(std::chrono::abs(difference) < std::chrono::seconds(1));
+}
+
+BOOST_AUTO_TEST_CASE(incrementalTimestamps)
+{
+  std::vector<long long int> values = {
+    1572830914000000000LL, 1572830914000000001LL, 1572830914000000999LL, 1572830914000001000LL,
+    1572830999999999999LL, 1572831000000000000LL, 1572830914000000000LL, 5, 9, 10, 99999, 100000, -1, 0,
+    9223372036854775807LL
+  };
+  TimestampFormatter formatter;
+  for (auto value : values) {
+    std::string out = "x";
+    formatter.append(out, value);
+    BOOST_CHECK_EQUAL(out, "x" + std::to_string(value));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(replaceTag)
+{
+  auto point = Point{"test"}.addTag("host", "a").addTag("request", "12345").addField("value", 10);
+  BOOST_CHECK(point.replaceTag("request", "_overflow"));
+  BOOST_CHECK(point.replaceTag("host", "bb"));
+  BOOST_CHECK(!point.replaceTag("hos", "c"));
+  BOOST_CHECK_EQUAL(point.getTagsView(), ",host=bb,request=_overflow");
+  BOOST_CHECK_EQUAL(point.getNameView(), "test");
+}
+
 } // namespace test
 } // namespace influxdb
@@ -0,0 +1,146 @@
+#define BOOST_TEST_MODULE Test InfluxDB Priority
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDB.h"
+#include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+namespace influxdb {
+namespace test {
+
+/// Records transmissions, failing the first ones and taking a while for each
+class Recording : public Transport
+{
+  public:
+    Recording(int failures = 0, std::chrono::milliseconds delay = std::chrono::milliseconds(0)) :
+      mFailures(failures), mDelay(delay) {}
+    void send(std::string&& message) override {
+      std::this_thread::sleep_for(mDelay);
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (mFailures > 0) {
+        mFailures--;
+        throw std::runtime_error("Unavailable");
+      }
+      mSent.push_back(std::move(message));
+    }
+    std::vector<std::string> sent() {
+      std::lock_guard<std::mutex> lock(mMutex);
+      return mSent;
+    }
+  private:
+    std::mutex mMutex;
+    int mFailures;
+    std::chrono::milliseconds mDelay;
+    std::vector<std::string> mSent;
+};
+
+Point point(const std::string& name)
+{
+  return Point{name}.addField("value", 1).setTimestamp(std::chrono::time_point<std::chrono::system_clock>{});
+}
+
+BOOST_AUTO_TEST_CASE(highPriorityOvertakes)
+{
+  auto recording = new Recording(0, std::chrono::milliseconds(5));
+  InfluxDB influxdb{std::unique_ptr<Transport>(recording)};
+  influxdb.priorityLanes({1, std::chrono::milliseconds(0), 8, 0}, {1, std::chrono::milliseconds(0), 4, 0},
+    {10, std::chrono::milliseconds(0), 1, 0});
+  for (int i = 0; i < 200; i++) {
+    influxdb.write(point("low"), Priority::Low);
+  }
+  influxdb.write(point("alert"), Priority::High);
+  influxdb.flushBuffer();
+
+  auto sent = recording->sent();
+  BOOST_REQUIRE_EQUAL(sent.size(), 21);
+  auto alert = std::find(sent.begin(), sent.end(), "alert value=1i 0\n");
+  BOOST_REQUIRE(alert != sent.end());
+  // waits at most for the batch being transmitted
+  BOOST_CHECK(alert - sent.begin() <= 2);
+}
+
+BOOST_AUTO_TEST_CASE(shedLowerPriorities)
+{
+  auto recording = new Recording;
+  InfluxDB influxdb{std::unique_ptr<Transport>(recording)};
+  Lane held{1000, std::chrono::hours(1), 1, 0};
+  influxdb.priorityLanes(held, held, held);
+  influxdb.memoryBudget(point("low").size() * 10, Backpressure::Drop);
+  for (int i = 0; i < 10; i++) {
+    influxdb.write(point("low"), Priority::Low);
+  }
+  for (int i = 0; i < 4; i++) {
+    influxdb.write(point("nor"), Priority::Normal);
+  }
+  influxdb.write(point("hig"), Priority::High);
+  BOOST_CHECK(!influxdb.tryWrite(point("low"), Priority::Low));
+
+  auto stats = influxdb.stats();
+  BOOST_CHECK_EQUAL(stats.shed, 5);
+  BOOST_CHECK_EQUAL(stats.dropped, 1);
+  BOOST_CHECK_EQUAL(stats.pendingBytes, point("low").size() * 10);
+  influxdb.flushBuffer();
+  BOOST_CHECK_EQUAL(influxdb.stats().pendingBytes, 0);
+
+  std::size_t lines = 0;
+  for (const auto& message : recording->sent()) {
+    lines += std::count(message.begin(), message.end(), '\n');
+  }
+  BOOST_CHECK_EQUAL(lines, 10);
+}
+
+BOOST_AUTO_TEST_CASE(retryFailed)
+{
+  auto recording = new Recording(2);
+  InfluxDB influxdb{std::unique_ptr<Transport>(recording)};
+  influxdb.priorityLanes({10, std::chrono::milliseconds(0), 8, 3}, {10, std::chrono::milliseconds(0), 4, 0},
+    {10, std::chrono::milliseconds(0), 1, 0});
+  influxdb.write(point("normal"));
+  influxdb.flushBuffer();
+  BOOST_CHECK_EQUAL(influxdb.stats().failed, 1);
+
+  influxdb.write(point("alert"), Priority::High);
+  influxdb.flushBuffer();
+  BOOST_CHECK_EQUAL(influxdb.stats().failed, 1);
+  auto sent = recording->sent();
+  BOOST_REQUIRE_EQUAL(sent.size(), 1);
+  BOOST_CHECK_EQUAL(sent[0], "alert value=1i 0\n");
+}
+
+BOOST_AUTO_TEST_CASE(bufferedBeforeLanes)
+{
+  auto recording = new Recording();
+  InfluxDB influxdb{std::unique_ptr<Transport>(recording)};
+  influxdb.batchOf(100);
+  influxdb.write(point("early"));
+  influxdb.write(point("early"));
+  influxdb.priorityLanes();
+  influxdb.write(point("alert"), Priority::High);
+  influxdb.flushBuffer();
+
+  std::string sent;
+  for (const auto& batch : recording->sent()) {
+    sent += batch;
+  }
+  BOOST_CHECK_EQUAL(std::count(sent.begin(), sent.end(), '\n'), 3);
+  BOOST_CHECK_EQUAL(sent.find("early value=1i 0\nearly value=1i 0\n") != std::string::npos, true);
+}
+
+BOOST_AUTO_TEST_CASE(partialBatchAfterDelay)
+{
+  auto influxdb = InfluxDBFactory::Get("memory://lanes");
+  influxdb->priorityLanes({100, std::chrono::milliseconds(20), 8, 0});
+  influxdb->write(point("alert"), Priority::High);
+  BOOST_CHECK(transports::Memory::Read("lanes").empty());
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  BOOST_CHECK_EQUAL(transports::Memory::Drain("lanes").size(), 1);
+  transports::Memory::Release("lanes");
+}
+
+} // namespace test
+} // namespace influxdb
@@ -3,6 +3,9 @@
 #include <boost/test/unit_test.hpp>
 #include "../include/InfluxDBFactory.h"
 #include "../src/InfluxDBException.h"
+#include "../src/TimestampParser.h"
+
+#include <future>
 
 namespace influxdb {
 namespace test {
@@ -25,19 +28,98 @@ BOOST_AUTO_TEST_CASE(query1)
   BOOST_CHECK_EQUAL(points[2].getTags(), "host=localhost");
 }
 
-BOOST_AUTO_TEST_CASE(timeStampVerify)
+BOOST_AUTO_TEST_CASE(queryAsync)
+{
+  auto influxdb = influxdb::InfluxDBFactory::Get("http://localhost:8086?db=test");
+  std::vector<std::future<std::vector<Point>>> futures;
+  for (int i = 0; i < 16; i++) {
+    futures.push_back(influxdb->queryAsync("SELECT * from test WHERE host = 'localhost' LIMIT 3"));
+  }
+  for (auto& future : futures) {
+    auto points = future.get();
+    BOOST_CHECK_EQUAL(points.size(), 3);
+    BOOST_CHECK_EQUAL(points[0].getFields(), "value=10");
+  }
+  auto failed = influxdb->queryAsync("SELECT *from test1 WHEREhost = 'localhost' LIMIT 3");
+  BOOST_CHECK_THROW(failed.get(), InfluxDBException);
+}
+
+BOOST_AUTO_TEST_CASE(queryChunked)
 {
-  double timeZone = 3600; //+1h
+  auto influxdb = influxdb::InfluxDBFactory::Get("http://localhost:8086?db=test");
+  std::promise<void> done;
+  std::vector<std::size_t> chunks;
+  influxdb->queryChunked("SELECT * from test WHERE host = 'localhost' LIMIT 3",
+    [&](std::vector<Point>&& points, bool last, std::exception_ptr error) {
+      if (!points.empty()) {
+        chunks.push_back(points.size());
+      }
+      if (error) {
+        done.set_exception(error);
+      } else if (last) {
+        done.set_value();
+      }
+    }, 2);
+  done.get_future().get();
+  BOOST_CHECK(chunks == (std::vector<std::size_t>{2, 1}));
+}
 
+BOOST_AUTO_TEST_CASE(queryBatch)
+{
+  auto influxdb = influxdb::InfluxDBFactory::Get("http://localhost:8086?db=test");
+  auto results = influxdb->queryBatch({
+    "SELECT * from test WHERE host = 'localhost' LIMIT 3",
+    "SELECT * from test1 WHERE host = 'localhost' LIMIT 3",
+    "SELECT * from test WHERE host = 'localhost' LIMIT 1",
+    "SELECT * from test WHERE host = 'localhost' GROUP BY time(1m)"
+  });
+  BOOST_CHECK_EQUAL(results.size(), 4);
+  BOOST_CHECK_EQUAL(results[0].points.size(), 3);
+  BOOST_CHECK_EQUAL(results[1].points.size(), 0);
+  BOOST_CHECK_EQUAL(results[2].points.size(), 1);
+  // failed statement does not discard results of others
+  BOOST_CHECK(!results[3].error.empty());
+
+  auto future = influxdb->queryBatchAsync({"SELECT * from test WHERE host = 'localhost' LIMIT 2"});
+  BOOST_CHECK_EQUAL(future.get().at(0).points.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(parseTimestamps)
+{
+  using namespace std::chrono;
+  time_point<system_clock> timestamp;
+  BOOST_CHECK(parseRfc3339("2019-11-04T01:28:34Z", timestamp));
+  BOOST_CHECK_EQUAL(duration_cast<seconds>(timestamp.time_since_epoch()).count(), 1572830914);
+  BOOST_CHECK(parseRfc3339("2019-11-04T01:28:34.123456789Z", timestamp));
+  BOOST_CHECK_EQUAL(duration_cast<nanoseconds>(timestamp.time_since_epoch()).count(), 1572830914123456789LL);
+  BOOST_CHECK(parseRfc3339("2019-11-04T01:28:34.5Z", timestamp));
+  BOOST_CHECK_EQUAL(duration_cast<milliseconds>(timestamp.time_since_epoch()).count(), 1572830914500LL);
+  BOOST_CHECK(parseRfc3339("2019-11-04T02:28:34+01:00", timestamp));
+  BOOST_CHECK_EQUAL(duration_cast<seconds>(timestamp.time_since_epoch()).count(), 1572830914);
+  BOOST_CHECK(parseRfc3339("1969-12-31T23:59:59Z", timestamp));
+  BOOST_CHECK_EQUAL(duration_cast<seconds>(timestamp.time_since_epoch()).count(), -1);
+  BOOST_CHECK(parseRfc3339("2020-02-29T00:00:00Z", timestamp));
+  BOOST_CHECK_EQUAL(duration_cast<seconds>(timestamp.time_since_epoch()).count(), 1582934400);
+  BOOST_CHECK(!parseRfc3339("2019-11-04 01:28", timestamp));
+  BOOST_CHECK(!parseRfc3339("2019-13-04T01:28:34Z", timestamp));
+  BOOST_CHECK(!parseRfc3339("2019-11-04T01:28:34.Z", timestamp));
+
+  BOOST_CHECK(parseEpoch("1572830914123", Precision::Milliseconds, timestamp));
+  BOOST_CHECK_EQUAL(duration_cast<milliseconds>(timestamp.time_since_epoch()).count(), 1572830914123LL);
+  BOOST_CHECK(parseEpoch("1572830914123456789", Precision::Nanoseconds, timestamp));
+  BOOST_CHECK_EQUAL(duration_cast<nanoseconds>(timestamp.time_since_epoch()).count(), 1572830914123456789LL);
+  BOOST_CHECK(!parseEpoch("2019-11-04T01:28:34Z", Precision::Nanoseconds, timestamp));
+}
+
+BOOST_AUTO_TEST_CASE(timeStampVerify)
+{
   auto influxdb = influxdb::InfluxDBFactory::Get("http://localhost:8086?db=test");
   Point point = Point{"timestampCheck"}.addField("value", 10);
   auto timestamp = point.getTimestamp();
   influxdb->write(std::move(point));
 
   auto points = influxdb->query("SELECT * from timestampCheck ORDER BY DESC LIMIT 1");
-  std::chrono::duration<double> diff = timestamp - points[0].getTimestamp();
-  double diffZone = diff.count() - timeZone;
-  BOOST_CHECK(diffZone < 1); // 1s
+  BOOST_CHECK(timestamp == points[0].getTimestamp());
 }
 
 BOOST_AUTO_TEST_CASE(queryPerformance)
@@ -0,0 +1,106 @@
+#define BOOST_TEST_MODULE Test InfluxDB Query Cache
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../src/QueryCache.h"
+
+#include <thread>
+
+namespace influxdb {
+namespace test {
+
+using namespace std::chrono;
+
+Point bucket(const std::string& host, int minute, int value)
+{
+  return Point{"cpu"}.addTag("host", host).addField("mean", value)
+    .setTimestamp(time_point<system_clock>(minutes(minute)));
+}
+
+BOOST_AUTO_TEST_CASE(normalize)
+{
+  BOOST_CHECK_EQUAL(QueryCache::Normalize("  SELECT *\n\tFROM  cpu WHERE host = 'a  b' ;"),
+    "SELECT * FROM cpu WHERE host = 'a  b'");
+  BOOST_CHECK_EQUAL(QueryCache::BucketInterval("SELECT mean(v) FROM cpu GROUP BY time(1m), host").count(), 60000000000LL);
+  BOOST_CHECK_EQUAL(QueryCache::BucketInterval("select mean(v) from cpu group by host, time( 10s )").count(), 10000000000LL);
+  BOOST_CHECK_EQUAL(QueryCache::BucketInterval("SELECT mean(v) FROM cpu GROUP BY time(1m,15s)").count(), 0);
+  BOOST_CHECK_EQUAL(QueryCache::BucketInterval("SELECT mean(v) FROM cpu GROUP BY time(1m) LIMIT 5").count(), 0);
+  BOOST_CHECK_EQUAL(QueryCache::BucketInterval("SELECT mean(v) FROM cpu WHERE x = 'GROUP BY time(1m)'").count(), 0);
+  BOOST_CHECK_EQUAL(QueryCache::Window("SELECT mean(v) FROM cpu WHERE time > now() - 1h GROUP BY time(1m)").count(),
+    3600000000000LL);
+  BOOST_CHECK_EQUAL(QueryCache::Restrict("SELECT mean(v) FROM cpu WHERE a = 1 OR b = 2 GROUP BY time(1m)",
+    time_point<system_clock>(seconds(60))), "SELECT mean(v) FROM cpu WHERE time >= 60000000000 AND (a = 1 OR b = 2) GROUP BY time(1m)");
+  BOOST_CHECK_EQUAL(QueryCache::Restrict("SELECT mean(v) FROM cpu GROUP BY time(1m)",
+    time_point<system_clock>(seconds(60))), "SELECT mean(v) FROM cpu WHERE time >= 60000000000 GROUP BY time(1m)");
+}
+
+BOOST_AUTO_TEST_CASE(ttl)
+{
+  QueryCache cache(milliseconds(50), false);
+  int fetches = 0;
+  auto fetch = [&](const std::string&) {
+    fetches++;
+    return std::vector<Point>{bucket("a", 1, fetches)};
+  };
+  BOOST_CHECK_EQUAL(cache.get("SELECT * FROM cpu", fetch).at(0).getFields(), "mean=1i");
+  BOOST_CHECK_EQUAL(cache.get("SELECT  *  FROM cpu;", fetch).at(0).getFields(), "mean=1i");
+  BOOST_CHECK_EQUAL(fetches, 1);
+  std::this_thread::sleep_for(milliseconds(60));
+  BOOST_CHECK_EQUAL(cache.get("SELECT * FROM cpu", fetch).at(0).getFields(), "mean=2i");
+
+  // statements with side effects always reach the server
+  cache.get("SELECT * INTO copy FROM cpu", fetch);
+  cache.get("SELECT * INTO copy FROM cpu", fetch);
+  cache.get("DROP MEASUREMENT cpu", fetch);
+  BOOST_CHECK_EQUAL(fetches, 5);
+}
+
+BOOST_AUTO_TEST_CASE(incremental)
+{
+  QueryCache cache(milliseconds(0), true);
+  std::vector<std::string> queries;
+  auto fetch = [&](const std::string& query) {
+    queries.push_back(query);
+    if (queries.size() == 1) {
+      return std::vector<Point>{bucket("a", 1, 1), bucket("a", 2, 2), bucket("a", 3, 3), bucket("b", 1, 10), bucket("b", 2, 20)};
+    }
+    return std::vector<Point>{bucket("a", 2, 2), bucket("a", 3, 4), bucket("a", 4, 5), bucket("b", 2, 21)};
+  };
+  std::string query = "SELECT mean(value) FROM cpu GROUP BY time(1m), host";
+  cache.get(query, fetch);
+  auto points = cache.get(query, fetch);
+
+  BOOST_REQUIRE_EQUAL(queries.size(), 2);
+  // last bucket of "b" starts at the second minute, everything from it on is refreshed
+  BOOST_CHECK_EQUAL(queries[1], "SELECT mean(value) FROM cpu WHERE time >= 120000000000 GROUP BY time(1m), host");
+  BOOST_REQUIRE_EQUAL(points.size(), 6);
+  BOOST_CHECK_EQUAL(points[0].getFields(), "mean=1i");
+  BOOST_CHECK_EQUAL(points[2].getFields(), "mean=4i");
+  BOOST_CHECK_EQUAL(points[3].getFields(), "mean=5i");
+  BOOST_CHECK_EQUAL(points[4].getTags(), "host=b");
+  BOOST_CHECK_EQUAL(points[4].getFields(), "mean=10i");
+  BOOST_CHECK_EQUAL(points[5].getFields(), "mean=21i");
+}
+
+BOOST_AUTO_TEST_CASE(slidingWindow)
+{
+  QueryCache cache(milliseconds(0), true);
+  auto now = system_clock::now();
+  int fetches = 0;
+  auto fetch = [&](const std::string&) {
+    if (fetches++ == 0) {
+      return std::vector<Point>{Point{"cpu"}.addField("mean", 1).setTimestamp(now - hours(2)),
+        Point{"cpu"}.addField("mean", 1).setTimestamp(now)};
+    }
+    return std::vector<Point>{Point{"cpu"}.addField("mean", 2).setTimestamp(now)};
+  };
+  std::string query = "SELECT mean(value) FROM cpu WHERE time > now() - 1h GROUP BY time(1s)";
+  cache.get(query, fetch);
+  auto points = cache.get(query, fetch);
+  // bucket older than the window is dropped, refreshed result replaces the trailing one
+  BOOST_REQUIRE_EQUAL(points.size(), 1);
+  BOOST_CHECK_EQUAL(points[0].getFields(), "mean=2i");
+}
+
+} // namespace test
+} // namespace influxdb
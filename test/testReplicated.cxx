@@ -0,0 +1,121 @@
+#define BOOST_TEST_MODULE Test InfluxDB Replicated
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
+#include "../src/Replicated.h"
+#include "../src/InfluxDBException.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace influxdb {
+namespace test {
+
+/// Payload addresses received by a sender thread
+struct Payloads
+{
+  void push_back(const std::string* payload) {
+    std::lock_guard<std::mutex> lock(mutex);
+    addresses.push_back(payload);
+  }
+  std::vector<const std::string*> get() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return addresses;
+  }
+  std::mutex mutex;
+  std::vector<const std::string*> addresses;
+};
+
+/// Records payload addresses, optionally blocking until released
+struct Recorder : public Transport
+{
+  Recorder(std::atomic<bool>& release, Payloads& payloads) :
+    mRelease(release), mPayloads(payloads) {}
+  void send(std::string&&) override { throw std::runtime_error("Copy not expected"); }
+  void sendShared(const std::shared_ptr<const std::string>& message) override {
+    while (!mRelease) std::this_thread::yield();
+    mPayloads.push_back(message.get());
+  }
+  std::atomic<bool>& mRelease;
+  Payloads& mPayloads;
+};
+
+BOOST_AUTO_TEST_CASE(noDestinations)
+{
+  BOOST_CHECK_THROW(influxdb::InfluxDBFactory::GetReplicated({}), InfluxDBException);
+}
+
+BOOST_AUTO_TEST_CASE(fanOut)
+{
+  {
+    auto influxdb = influxdb::InfluxDBFactory::GetReplicated({"memory://replica0", "memory://replica1"});
+    influxdb->write(Point{"test"}.addField("value", 10));
+    influxdb->write(Point{"test"}.addField("value", 20));
+  }
+  auto first = transports::Memory::Drain("replica0");
+  auto second = transports::Memory::Drain("replica1");
+  BOOST_CHECK_EQUAL(first.size(), 2);
+  BOOST_CHECK(first == second);
+  transports::Memory::Release("replica0");
+  transports::Memory::Release("replica1");
+}
+
+BOOST_AUTO_TEST_CASE(sharedPayloadAndSlowReplica)
+{
+  std::atomic<bool> fast{true}, slow{false};
+  Payloads fastPayloads, slowPayloads;
+  std::vector<std::unique_ptr<Transport>> destinations;
+  destinations.push_back(std::make_unique<Recorder>(fast, fastPayloads));
+  destinations.push_back(std::make_unique<Recorder>(slow, slowPayloads));
+  auto transport = std::make_unique<transports::Replicated>(std::move(destinations), 8);
+
+  for (int i = 0; i < 3; i++) {
+    transport->send("test value=" + std::to_string(i) + "i");
+  }
+  // first replica progresses while the second one is blocked
+  for (int i = 0; i < 1000 && fastPayloads.get().size() < 3; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_CHECK_EQUAL(fastPayloads.get().size(), 3);
+  BOOST_CHECK_EQUAL(slowPayloads.get().size(), 0);
+
+  slow = true;
+  transport.reset();
+  BOOST_CHECK(slowPayloads.get() == fastPayloads.get());
+}
+
+BOOST_AUTO_TEST_CASE(dropOldest)
+{
+  std::atomic<bool> release{false};
+  Payloads payloads;
+  std::vector<std::unique_ptr<Transport>> destinations;
+  destinations.push_back(std::make_unique<Recorder>(release, payloads));
+  transports::Replicated transport(std::move(destinations), 1);
+  for (int i = 0; i < 3; i++) {
+    transport.send("test value=" + std::to_string(i) + "i");
+  }
+  BOOST_CHECK(transport.dropped(0) >= 1);
+  BOOST_CHECK_EQUAL(transport.dropped(), transport.dropped(0));
+  release = true;
+}
+
+BOOST_AUTO_TEST_CASE(failuresInStats)
+{
+  // nothing listens on port 1
+  auto influxdb = influxdb::InfluxDBFactory::GetReplicated({"memory://replica2", "http://127.0.0.1:1/?db=test"});
+  influxdb->write(Point{"test"}.addField("value", 10));
+  for (int i = 0; i < 5000 && influxdb->stats().transportFailed == 0; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_CHECK_EQUAL(influxdb->stats().transportFailed, 1);
+  BOOST_CHECK_EQUAL(influxdb->stats().transportDropped, 0);
+  influxdb.reset();
+  BOOST_CHECK_EQUAL(transports::Memory::Drain("replica2").size(), 1);
+  transports::Memory::Release("replica2");
+}
+
+} // namespace test
+} // namespace influxdb
@@ -0,0 +1,107 @@
+#define BOOST_TEST_MODULE Test InfluxDB Sharded
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDBFactory.h"
+#include "../include/Memory.h"
+#include "../src/Sharded.h"
+#include "../src/InfluxDBException.h"
+
+#include <map>
+
+namespace influxdb {
+namespace test {
+
+BOOST_AUTO_TEST_CASE(seriesKey)
+{
+  BOOST_CHECK_EQUAL(transports::Sharded::SeriesKey("cpu,host=a value=1i 10"), "cpu,host=a");
+  BOOST_CHECK_EQUAL(transports::Sharded::SeriesKey("cpu,host=a\\ b value=1i"), "cpu,host=a\\ b");
+  BOOST_CHECK_EQUAL(transports::Sharded::SeriesKey("cpu"), "cpu");
+}
+
+BOOST_AUTO_TEST_CASE(noShards)
+{
+  BOOST_CHECK_THROW(influxdb::InfluxDBFactory::GetSharded({}), InfluxDBException);
+}
+
+BOOST_AUTO_TEST_CASE(routeBySeries)
+{
+  std::vector<std::string> urls = {"memory://shard0", "memory://shard1", "memory://shard2"};
+  {
+    auto influxdb = influxdb::InfluxDBFactory::GetSharded(urls);
+    influxdb->batchOf(100);
+    for (int round = 0; round < 3; round++) {
+      for (int host = 0; host < 30; host++) {
+        influxdb->write(Point{"test"}.addField("value", round).addTag("host", "host" + std::to_string(host)));
+      }
+    }
+  }
+
+  std::map<std::string, std::string> owner;
+  std::size_t lines = 0;
+  for (const auto& url : urls) {
+    auto name = url.substr(9);
+    auto batches = transports::Memory::Drain(name);
+    BOOST_CHECK(!batches.empty());
+    for (const auto& batch : batches) {
+      std::istringstream stream(batch);
+      std::string line;
+      while (std::getline(stream, line)) {
+        auto series = std::string(transports::Sharded::SeriesKey(line));
+        auto inserted = owner.emplace(series, name);
+        BOOST_CHECK_EQUAL(inserted.first->second, name);
+        lines++;
+      }
+    }
+    transports::Memory::Release(name);
+  }
+  BOOST_CHECK_EQUAL(lines, 90);
+  BOOST_CHECK_EQUAL(owner.size(), 30);
+}
+
+BOOST_AUTO_TEST_CASE(consistentRouting)
+{
+  std::vector<std::pair<std::string, std::unique_ptr<Transport>>> three, four;
+  for (int i = 0; i < 4; i++) {
+    auto name = "node" + std::to_string(i);
+    if (i < 3) three.emplace_back(name, std::make_unique<transports::Memory>());
+    four.emplace_back(name, std::make_unique<transports::Memory>());
+  }
+  transports::Sharded before(std::move(three)), after(std::move(four));
+  int moved = 0;
+  for (int i = 0; i < 1000; i++) {
+    auto key = "cpu,host=host" + std::to_string(i);
+    auto target = after.route(key);
+    if (target != before.route(key)) {
+      moved++;
+      BOOST_CHECK_EQUAL(target, 3);
+    }
+  }
+  // roughly one quarter of the series moves to the new shard
+  BOOST_CHECK(moved > 150 && moved < 350);
+}
+
+/// Shard failing every send
+struct Failing : public Transport
+{
+  void send(std::string&&) override { throw InfluxDBException("Failing::send", "Shard down"); }
+};
+
+BOOST_AUTO_TEST_CASE(failingShard)
+{
+  std::vector<std::pair<std::string, std::unique_ptr<Transport>>> shards;
+  shards.emplace_back("healthy", std::make_unique<transports::Memory>("healthy"));
+  shards.emplace_back("failing", std::make_unique<Failing>());
+  transports::Sharded sharded(std::move(shards));
+  std::string batch;
+  for (int host = 0; host < 30; host++) {
+    batch += "test,host=host" + std::to_string(host) + " value=1i\n";
+  }
+  // error is reported once all shards finished, the healthy one still receives its lines
+  BOOST_CHECK_THROW(sharded.send(std::move(batch)), InfluxDBException);
+  BOOST_CHECK_EQUAL(transports::Memory::Drain("healthy").size(), 1);
+  transports::Memory::Release("healthy");
+}
+
+} // namespace test
+} // namespace influxdb
@@ -0,0 +1,116 @@
+#define BOOST_TEST_MODULE Test InfluxDB Shared Memory
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDBFactory.h"
+#include "../src/SharedMemory.h"
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+namespace influxdb {
+namespace test {
+
+using transports::SharedMemory;
+
+BOOST_AUTO_TEST_CASE(roundTrip)
+{
+  SharedMemory::Unlink("influxdb-test-roundtrip");
+  SharedMemory producer("influxdb-test-roundtrip", 4096);
+  SharedMemory consumer("influxdb-test-roundtrip");
+  producer.send("test value=1i");
+  producer.send("test value=2i\ntest value=3i\n");
+  std::string batch;
+  BOOST_CHECK_EQUAL(consumer.drain(batch, 1024), 2);
+  BOOST_CHECK_EQUAL(batch, "test value=1i\ntest value=2i\ntest value=3i\n");
+  batch.clear();
+  BOOST_CHECK_EQUAL(consumer.drain(batch, 1024), 0);
+  SharedMemory::Unlink("influxdb-test-roundtrip");
+}
+
+BOOST_AUTO_TEST_CASE(fullAndWrapAround)
+{
+  SharedMemory::Unlink("influxdb-test-wrap");
+  SharedMemory ring("influxdb-test-wrap", 4096);
+  std::string message(100, 'x');
+  for (int i = 0; i < 50; i++) {
+    ring.send(std::string(message));
+  }
+  // 112 bytes per record, 36 fit
+  BOOST_CHECK_EQUAL(ring.dropped(), 14);
+  ring.send(std::string(3000, 'y'));
+  BOOST_CHECK_EQUAL(ring.dropped(), 15);
+
+  std::string batch;
+  BOOST_CHECK_EQUAL(ring.drain(batch, 1000), 9);
+  batch.clear();
+  BOOST_CHECK_EQUAL(ring.drain(batch, 1 << 20), 27);
+
+  // records crossing the end of the ring start over at its beginning
+  for (int i = 0; i < 100; i++) {
+    ring.send("message" + std::to_string(i));
+    batch.clear();
+    BOOST_REQUIRE_EQUAL(ring.drain(batch, 1 << 20), 1);
+    BOOST_CHECK_EQUAL(batch, "message" + std::to_string(i) + "\n");
+  }
+  BOOST_CHECK_EQUAL(ring.dropped(), 15);
+  SharedMemory::Unlink("influxdb-test-wrap");
+}
+
+BOOST_AUTO_TEST_CASE(multipleProducers)
+{
+  SharedMemory::Unlink("influxdb-test-mpsc");
+  SharedMemory ring("influxdb-test-mpsc", 64 * 1024);
+  const int producers = 4, count = 20000;
+  std::atomic<int> finished{0};
+  std::vector<std::thread> threads;
+  for (int producer = 0; producer < producers; producer++) {
+    threads.emplace_back([&, producer] {
+      SharedMemory handle("influxdb-test-mpsc");
+      for (int i = 0; i < count; i++) {
+        handle.send("p" + std::to_string(producer) + " " + std::to_string(i));
+      }
+      finished++;
+    });
+  }
+  std::vector<int> last(producers, -1);
+  std::size_t received = 0;
+  bool ordered = true;
+  std::string batch;
+  for (;;) {
+    bool done = finished == producers;
+    batch.clear();
+    received += ring.drain(batch, 1 << 20);
+    std::istringstream lines(batch);
+    std::string name;
+    int sequence;
+    while (lines >> name >> sequence) {
+      auto producer = std::stoi(name.substr(1));
+      ordered = ordered && sequence > last[producer];
+      last[producer] = sequence;
+    }
+    if (done && batch.empty()) break;
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  BOOST_CHECK(ordered);
+  BOOST_CHECK_EQUAL(received + ring.dropped(), producers * count);
+  SharedMemory::Unlink("influxdb-test-mpsc");
+}
+
+BOOST_AUTO_TEST_CASE(factory)
+{
+  SharedMemory::Unlink("influxdb-test-factory");
+  auto influxdb = InfluxDBFactory::Get("shm://influxdb-test-factory?size=8192");
+  influxdb->write(Point{"test"}.addField("value", 10));
+  SharedMemory consumer("influxdb-test-factory");
+  std::string batch;
+  BOOST_CHECK_EQUAL(consumer.drain(batch, 1024), 1);
+  BOOST_CHECK_EQUAL(batch.substr(0, 15), "test value=10i ");
+  SharedMemory::Unlink("influxdb-test-factory");
+}
+
+} // namespace test
+} // namespace influxdb
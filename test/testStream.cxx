@@ -0,0 +1,93 @@
+#define BOOST_TEST_MODULE Test InfluxDB Stream
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "../include/InfluxDBFactory.h"
+#include "../src/InfluxDBException.h"
+
+#include <boost/asio.hpp>
+#include <cstdio>
+
+namespace influxdb {
+namespace test {
+
+using boost::asio::ip::tcp;
+
+/// \return next line received over the connection
+template<typename Socket>
+std::string readLine(Socket& socket, boost::asio::streambuf& buffer)
+{
+  boost::asio::read_until(socket, buffer, '\n');
+  std::istream stream(&buffer);
+  std::string line;
+  std::getline(stream, line);
+  return line;
+}
+
+BOOST_AUTO_TEST_CASE(tcpBatches)
+{
+  boost::asio::io_service service;
+  tcp::acceptor acceptor(service, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+  auto port = std::to_string(acceptor.local_endpoint().port());
+
+  auto influxdb = InfluxDBFactory::Get("tcp://127.0.0.1:" + port + "?cork=1&bufferSize=65536");
+  influxdb->batchOf(2);
+  for (int i = 0; i < 4; i++) {
+    influxdb->write(Point{"test"}.addField("value", i).setTimestamp(std::chrono::time_point<std::chrono::system_clock>{}));
+  }
+  // a datagram would end each batch, a stream has to separate them
+  tcp::socket connection(service);
+  acceptor.accept(connection);
+  boost::asio::streambuf buffer;
+  for (int i = 0; i < 4; i++) {
+    BOOST_CHECK_EQUAL(readLine(connection, buffer), "test value=" + std::to_string(i) + "i 0");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(tcpReconnect)
+{
+  boost::asio::io_service service;
+  tcp::acceptor acceptor(service, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+  auto port = std::to_string(acceptor.local_endpoint().port());
+  auto transport = InfluxDBFactory::GetTransport("tcp://127.0.0.1:" + port);
+
+  boost::asio::streambuf buffer;
+  transport->send("first 1");
+  {
+    tcp::socket connection(service);
+    acceptor.accept(connection);
+    BOOST_CHECK_EQUAL(readLine(connection, buffer), "first 1");
+  }
+  // server closed the connection, the next write goes over a new one
+  transport->send("second 2\n");
+  tcp::socket connection(service);
+  acceptor.accept(connection);
+  BOOST_CHECK_EQUAL(readLine(connection, buffer), "second 2");
+
+  acceptor.close();
+  connection.close();
+  BOOST_CHECK_THROW(transport->send("third 3"), InfluxDBException);
+}
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+BOOST_AUTO_TEST_CASE(unixStream)
+{
+  using boost::asio::local::stream_protocol;
+  std::string path = "/tmp/influxdb-cxx-test-stream.sock";
+  std::remove(path.c_str());
+  boost::asio::io_service service;
+  stream_protocol::acceptor acceptor(service, stream_protocol::endpoint(path));
+
+  auto transport = InfluxDBFactory::GetTransport("unix+stream://" + path);
+  transport->send("first 1\nfirst 2");
+  stream_protocol::socket connection(service);
+  acceptor.accept(connection);
+  boost::asio::streambuf buffer;
+  BOOST_CHECK_EQUAL(readLine(connection, buffer), "first 1");
+  BOOST_CHECK_EQUAL(readLine(connection, buffer), "first 2");
+  std::remove(path.c_str());
+}
+#endif // defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+} // namespace test
+} // namespace influxdb
@@ -3,6 +3,12 @@
 #include <boost/test/unit_test.hpp>
 
 #include "../include/InfluxDBFactory.h"
+#include "../src/UDP.h"
+#include "../src/UnixSocket.h"
+
+#include <boost/asio.hpp>
+#include <cstdio>
+#include <future>
 
 namespace influxdb {
 namespace test {
@@ -30,5 +36,111 @@ BOOST_AUTO_TEST_CASE(test2)
   influxdb->write(Point{"test"}.addField("value", 100LL));
 }
 
+BOOST_AUTO_TEST_CASE(contextReleasedByHandler)
+{
+  auto context = transports::IoContext::Get(1);
+  auto& service = context->get();
+  std::promise<void> released;
+  boost::asio::post(service, [context = std::move(context), &released]() mutable {
+    context.reset();
+    released.set_value();
+  });
+  released.get_future().get();
+  // torn down from another thread, a new context starts
+  auto next = transports::IoContext::Get(1);
+  std::promise<void> ran;
+  boost::asio::post(next->get(), [&ran] { ran.set_value(); });
+  BOOST_CHECK(ran.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+}
+
+BOOST_AUTO_TEST_CASE(asyncShared)
+{
+  using boost::asio::ip::udp;
+  boost::asio::io_context service;
+  udp::socket receiver(service, udp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+  auto port = receiver.local_endpoint().port();
+
+  auto context = transports::IoContext::Get(2);
+  BOOST_CHECK_EQUAL(transports::IoContext::Get(4), context);
+  BOOST_CHECK_EQUAL(context->threads(), 2);
+  {
+    transports::UDP first("127.0.0.1", port, context);
+    transports::UDP second("127.0.0.1", port, context);
+    for (int i = 0; i < 100; i++) {
+      first.send("first value=" + std::to_string(i));
+      second.sendShared(std::make_shared<const std::string>("second value=" + std::to_string(i)));
+    }
+    // destructors wait for queued messages
+  }
+  int first = 0, second = 0;
+  char datagram[64];
+  for (int i = 0; i < 200; i++) {
+    std::string message(datagram, receiver.receive(boost::asio::buffer(datagram)));
+    // each transport keeps order of its messages
+    if (message.rfind("first", 0) == 0) {
+      BOOST_CHECK_EQUAL(message, "first value=" + std::to_string(first++));
+    } else {
+      BOOST_CHECK_EQUAL(message, "second value=" + std::to_string(second++));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(asyncDropsWhenQueueFull)
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+  using boost::asio::local::datagram_protocol;
+  std::string path = "/tmp/influxdb-cxx-test-datagram.sock";
+  std::remove(path.c_str());
+  boost::asio::io_context service;
+  datagram_protocol::socket receiver(service, datagram_protocol::endpoint(path));
+  {
+    // nothing is received, the socket buffer fills up and the queue behind it
+    transports::UnixSocket transport(path, transports::IoContext::Get(), 16);
+    std::string payload(16 * 1024, 'x');
+    for (int i = 0; i < 1000; i++) {
+      transport.send(std::string(payload));
+    }
+    BOOST_CHECK(transport.dropped() > 0);
+  }
+  std::remove(path.c_str());
+#endif // defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+}
+
+BOOST_AUTO_TEST_CASE(resolveInBackground)
+{
+  using boost::asio::ip::udp;
+  boost::asio::io_context service;
+  udp::socket receiver(service, udp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+  {
+    // writes before the hostname is resolved are held
+    transports::UDP transport("localhost", receiver.local_endpoint().port());
+    for (int i = 0; i < 10; i++) {
+      transport.send("early value=" + std::to_string(i));
+    }
+  }
+  char datagram[64];
+  for (int i = 0; i < 10; i++) {
+    BOOST_CHECK_EQUAL(std::string(datagram, receiver.receive(boost::asio::buffer(datagram))),
+      "early value=" + std::to_string(i));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(unresolvedHost)
+{
+  auto start = std::chrono::steady_clock::now();
+  transports::UDP transport("influxdb.invalid", 8094, nullptr, 4);
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100));
+  for (int i = 0; i < 10; i++) {
+    transport.send("test value=1");
+  }
+  BOOST_CHECK(transport.dropped() >= 6);
+}
+
+BOOST_AUTO_TEST_CASE(asyncFactory)
+{
+  auto influxdb = influxdb::InfluxDBFactory::Get("udp://localhost:8084?async=1&ioThreads=2&maxPending=64");
+  influxdb->write(Point{"test"}.addField("value", 10));
+}
+
 } // namespace test
 } // namespace influxdb
@@ -0,0 +1,77 @@
+///
+/// \author Adam Wegrzynek <adam.wegrzynek@cern.ch>
+///
+/// Drains shared memory ring (shm:// transport) and relays batches of line protocol to another transport
+///
+
+#include "InfluxDBFactory.h"
+#include "SharedMemory.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+
+std::atomic<bool> running{true};
+
+void stop(int)
+{
+  running = false;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <ring name> <destination URL> [batch bytes] [flush interval ms] [ring bytes]"
+              << std::endl;
+    return 1;
+  }
+  std::size_t batchBytes = argc > 3 ? std::stoul(argv[3]) : 1024 * 1024;
+  std::chrono::milliseconds interval(argc > 4 ? std::stoul(argv[4]) : 100);
+  std::size_t ringBytes = argc > 5 ? std::stoul(argv[5]) : 16 * 1024 * 1024;
+
+  std::signal(SIGINT, stop);
+  std::signal(SIGTERM, stop);
+
+  try {
+    influxdb::transports::SharedMemory ring(argv[1], ringBytes);
+    auto transport = influxdb::InfluxDBFactory::GetTransport(argv[2]);
+    auto dropped = ring.dropped();
+    auto flushed = std::chrono::steady_clock::now();
+    std::string batch;
+    for (;;) {
+      bool stopping = !running;
+      auto taken = ring.drain(batch, batchBytes);
+      auto now = std::chrono::steady_clock::now();
+      if (!batch.empty() && (batch.size() >= batchBytes || now - flushed >= interval || stopping)) {
+        try {
+          transport->send(std::move(batch));
+        } catch (const std::exception& exception) {
+          std::cerr << exception.what() << std::endl;
+        }
+        batch.clear();
+        flushed = now;
+      }
+      if (ring.dropped() != dropped) {
+        std::cerr << "Ring full, " << ring.dropped() - dropped << " messages dropped" << std::endl;
+        dropped = ring.dropped();
+      }
+      if (taken == 0) {
+        if (stopping) {
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+  } catch (const std::exception& exception) {
+    std::cerr << exception.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}